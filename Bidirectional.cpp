@@ -0,0 +1,329 @@
+/*
+File Name : Bidirectional.cpp
+Copyright  2018
+Original authors : Sanketh Bhat
+Written under the supervision of David I.Schwartz, Ph.D., and
+supported by a professional development seed grant from the B.Thomas
+Golisano College of Computing & Information Sciences
+(https ://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software : you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.If not, see <http://www.gnu.org/licenses/>.
+
+
+Description:
+Bidirectional A*. One frontier grows from the start and one from the end, each on its own thread,
+and the search stops as soon as together they can't improve on the best route where they met.
+*/
+
+#include "Bidirectional.h"
+
+#include <cstring>
+
+static const float INF = std::numeric_limits<float>::infinity();
+
+Bidirectional::Bidirectional(const graph &map) : map(map), best(INF), stop(false)
+{
+	lowest[0] = lowest[1] = -INF;
+	helper = std::thread(&Bidirectional::work, this);
+}
+
+Bidirectional::~Bidirectional()
+{
+	{
+		std::lock_guard<std::mutex> l(lock);
+		quit = true;
+	}
+	wake.notify_one();
+
+	helper.join();
+}
+
+bool Bidirectional::findPath(Position from, Position to)
+{
+	int n = map.width() * map.height();
+	int s = map.unitId(from.x, from.y);
+	int t = map.unitId(to.x, to.y);
+
+	path.clear();
+	pathCost = 0;
+	expanded[0] = expanded[1] = 0;
+
+	//Same rule as graph::findPath: the start may be blocked, the end may not unless it is also the start
+	if (!map.passable(to.x, to.y) && s != t)
+		return false;
+
+	if (n != unitCount)
+	{
+		for (int i = 0; i < 2; i++)
+		{
+			reached[i].reset(new std::atomic<uint64_t>[n]);
+			for (int id = 0; id < n; id++)
+				reached[i][id] = 0;
+		}
+		unitCount = n;
+		generation = 0;
+	}
+
+	if (++generation == 0)
+	{
+		for (int i = 0; i < 2; i++)
+			for (int id = 0; id < n; id++)
+				reached[i][id] = 0;
+		generation = 1;
+	}
+
+	for (int i = 0; i < 2; i++)
+	{
+		sides[i].resize(n);
+		sides[i].newSearch();
+	}
+	sides[0].start = sides[1].goal = s;
+	sides[1].start = sides[0].goal = t;
+
+	best = INF;
+	meet = -1;
+	stop = false;
+	lowest[0] = lowest[1] = -INF;
+
+	//Both roots are visible before either side starts, so a side that reaches the other's root always meets it
+	publish(0, s, 0);
+	publish(1, t, 0);
+	offer(s, reachedCost(1, s));
+
+	switch (map.neighborhood)
+	{
+	case Neighborhood::four:
+		switch (map.heuristic)
+		{
+		case Heuristic::octile: run = pick<FourNeighbors, OctileHeuristic>(); break;
+		case Heuristic::manhattan: run = pick<FourNeighbors, ManhattanHeuristic>(); break;
+		case Heuristic::euclidean: run = pick<FourNeighbors, EuclideanHeuristic>(); break;
+		case Heuristic::none: run = pick<FourNeighbors, ZeroHeuristic>(); break;
+		case Heuristic::landmarks: run = pick<FourNeighbors, OctileHeuristic>(); break; //The average potential needs estimate(xd, yd)
+		}
+		break;
+	case Neighborhood::eight:
+		switch (map.heuristic)
+		{
+		case Heuristic::octile: run = pick<EightNeighbors, OctileHeuristic>(); break;
+		case Heuristic::manhattan: run = pick<EightNeighbors, ManhattanHeuristic>(); break;
+		case Heuristic::euclidean: run = pick<EightNeighbors, EuclideanHeuristic>(); break;
+		case Heuristic::none: run = pick<EightNeighbors, ZeroHeuristic>(); break;
+		case Heuristic::landmarks: run = pick<EightNeighbors, OctileHeuristic>(); break; //The average potential needs estimate(xd, yd)
+		}
+		break;
+	}
+
+	{
+		std::lock_guard<std::mutex> l(lock);
+		busy = true;
+		query++;
+	}
+	wake.notify_one();
+
+	(this->*run)(0);
+
+	{
+		std::unique_lock<std::mutex> l(lock);
+		done.wait(l, [this] { return !busy; });
+	}
+
+	if (meet == -1)
+		return false;
+
+	pathCost = best;
+	buildPath();
+
+	return true;
+}
+
+//Helper loop: sleeps until a query arrives, runs side 1 of it, then reports back
+void Bidirectional::work()
+{
+	unsigned seen = 0;
+
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> l(lock);
+			wake.wait(l, [&] { return quit || query != seen; });
+			if (quit)
+				return;
+			seen = query;
+		}
+
+		(this->*run)(1);
+
+		std::lock_guard<std::mutex> l(lock);
+		busy = false;
+		done.notify_one();
+	}
+}
+
+template<class N, class H>
+Bidirectional::SideSearch Bidirectional::pick() const
+{
+	switch (map.openListMode)
+	{
+	case OpenListMode::rebuild:
+		return &Bidirectional::search<N, H, RebuildQueue, &SearchContext::openUnits>;
+	case OpenListMode::indexedHeap:
+		return &Bidirectional::search<N, H, IndexedHeap, &SearchContext::openHeap>;
+	default:
+		return &Bidirectional::search<N, H, BucketQueue, &SearchContext::openBuckets>;
+	}
+}
+
+//Priority of unit id for a side: twice its cost so far plus the estimate to the other root minus the estimate
+//to its own root. Halved, the last two terms are the average potential of Goldberg and Harrelson. The two sides'
+//potentials cancel, so the search can stop as soon as the lowest priorities of both sides add up to twice
+//the best route, and each side only has to cover about half of what one A* would. Doubling keeps the
+//priorities whole numbers for the bucket queue. Estimates are scaled by the lowest weight on the map, as in graph.
+template<class H>
+static float sideKey(Position p, Position root, Position other, float g, float scale)
+{
+	return 2 * g + scale * (H::estimate(abs(other.x - p.x), abs(other.y - p.y)) - H::estimate(abs(root.x - p.x), abs(root.y - p.y)));
+}
+
+//Searches from the root of one side towards the root of the other. Moves are symmetric on the grid,
+//so the search from the end runs exactly like the one from the start.
+template<class N, class H, class OpenList, OpenList SearchContext::*list>
+void Bidirectional::search(int side)
+{
+	SearchContext &c = sides[side];
+	OpenList &open = c.*list;
+	Position r = map.position(c.start);
+	Position e = map.position(c.goal);
+	float scale = (float)map.lowestWeight();
+	int count = 0;
+
+	open.clear();
+
+	int s = c.start;
+	c.stamp[s] = c.generation;
+	c.g[s] = 0;
+	c.parent[s] = -1;
+	c.list[s] = ListStatus::open;
+	open.push(s, sideKey<H>(r, r, e, 0, scale));
+
+	while (!stop.load(std::memory_order_relaxed))
+	{
+		if (open.empty())
+		{
+			lowest[side] = INF;
+			stop = true;
+			break;
+		}
+
+		//Priorities only go up, so a stale value from the other side is never too high and the test stays safe
+		int u = open.top().id;
+		Position p = map.position(u);
+		float key = sideKey<H>(p, r, e, c.g[u], scale);
+		lowest[side] = key;
+		if (key + lowest[1 - side].load() >= 2 * best.load())
+		{
+			stop = true;
+			break;
+		}
+
+		open.pop();
+		c.list[u] = ListStatus::closed;
+		count++;
+
+		for (int i = 0; i < N::count; i++)
+		{
+			int x = p.x + N::dx(i);
+			int y = p.y + N::dy(i);
+			int n = map.unitId(x, y);
+
+			//The other side's root may be a blocked start, it still has to be reachable from the end
+			if (!map.passable(x, y) && !(x == e.x && y == e.y))
+				continue;
+
+			ListStatus ls = c.listStatus(n);
+			if (ls == ListStatus::closed)
+				continue;
+
+			float ng = c.g[u] + map.moveCost(u, n, N::cost(i));
+			float f = sideKey<H>({ x, y }, r, e, ng, scale);
+
+			if (ls != ListStatus::open)
+			{
+				c.stamp[n] = c.generation;
+				c.list[n] = ListStatus::open;
+				c.g[n] = ng;
+				c.parent[n] = u;
+				open.push(n, f);
+			}
+			else if (ng < c.g[n])
+			{
+				c.g[n] = ng;
+				c.parent[n] = u;
+				open.decreaseKey(n, f);
+			}
+			else
+				continue;
+
+			publish(side, n, ng);
+			offer(n, ng + reachedCost(1 - side, n));
+		}
+	}
+
+	expanded[side] = count;
+}
+
+//Stores are sequentially consistent: when both sides reach a unit, at least one of them sees the other's cost
+void Bidirectional::publish(int side, int id, float cost)
+{
+	uint32_t bits;
+	memcpy(&bits, &cost, sizeof(bits));
+	reached[side][id].store((uint64_t)generation << 32 | bits);
+}
+
+float Bidirectional::reachedCost(int side, int id) const
+{
+	uint64_t v = reached[side][id].load();
+	if ((uint32_t)(v >> 32) != generation)
+		return INF;
+
+	uint32_t bits = (uint32_t)v;
+	float cost;
+	memcpy(&cost, &bits, sizeof(cost));
+	return cost;
+}
+
+//A route through id costs cost. Improvements are rare, so the lock is only taken for those.
+void Bidirectional::offer(int id, float cost)
+{
+	if (!(cost < best.load()))
+		return;
+
+	std::lock_guard<std::mutex> l(meetLock);
+	if (cost < best.load())
+	{
+		best = cost;
+		meet = id;
+	}
+}
+
+//Start to the meeting unit from side 0's parents, then on to the end from side 1's
+void Bidirectional::buildPath()
+{
+	for (int u = meet; u != -1; u = sides[0].parent[u])
+		path.push_back(u);
+	std::reverse(path.begin(), path.end());
+
+	for (int u = sides[1].parent[meet]; u != -1; u = sides[1].parent[u])
+		path.push_back(u);
+}
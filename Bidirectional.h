@@ -0,0 +1,101 @@
+/*
+File Name : Bidirectional.h
+Copyright  2018
+Original authors : Sanketh Bhat
+Written under the supervision of David I.Schwartz, Ph.D., and
+supported by a professional development seed grant from the B.Thomas
+Golisano College of Computing & Information Sciences
+(https ://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software : you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.If not, see <http://www.gnu.org/licenses/>.
+
+
+Description:
+Bidirectional A*. One frontier grows from the start and one from the end, each on its own thread,
+and the search stops as soon as together they can't improve on the best route where they met.
+*/
+
+#ifndef BIDIRECTIONAL_H
+#define BIDIRECTIONAL_H
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+
+#include "graph.h"
+
+//Answers queries on a graph with two searches that meet in the middle. The search from the start runs
+//on the calling thread and the one from the end on a helper thread that lives as long as this object,
+//so a long query takes roughly half as long as one A* instead of only freeing up a core.
+//Uses the graph's neighborhood, heuristic and open list settings. The graph must not be edited during findPath.
+class Bidirectional {
+
+	typedef void (Bidirectional::*SideSearch)(int side);
+
+	const graph &map;
+	SearchContext sides[2]; //0 searches from the start, 1 from the end
+
+	//Cost each side has reached every unit with, so the other side can spot where they meet.
+	//A value is the query generation in the high 32 bits and the float cost in the low 32, written as one
+	//atomic so it can be read while the owner updates it. Stale generations read as unreached.
+	std::unique_ptr<std::atomic<uint64_t>[]> reached[2];
+	int unitCount = 0;
+	uint32_t generation = 0;
+
+	//Best meeting point so far. best only goes down and is read without the lock.
+	std::mutex meetLock;
+	std::atomic<float> best;
+	int meet = -1;
+	std::atomic<bool> stop;
+	std::atomic<float> lowest[2]; //Lowest priority in each side's open list, -infinity until the side starts
+
+	//Helper thread for side 1
+	std::thread helper;
+	std::mutex lock;
+	std::condition_variable wake;
+	std::condition_variable done;
+	SideSearch run = nullptr;
+	unsigned query = 0; //Bumped for every query so the helper knows there is work
+	bool busy = false;
+	bool quit = false;
+
+	void work();
+
+	template<class N, class H>
+	SideSearch pick() const;
+	template<class N, class H, class OpenList, OpenList SearchContext::*list>
+	void search(int side);
+
+	void publish(int side, int id, float cost);
+	float reachedCost(int side, int id) const;
+	void offer(int id, float cost);
+	void buildPath();
+
+public:
+	std::vector<int> path; //Unit ids of the route of the last findPath, start first
+	float pathCost = 0;
+	int expanded[2] = { 0, 0 }; //Units each side expanded in the last findPath
+
+	Bidirectional(const graph &map);
+	~Bidirectional();
+	Bidirectional(const Bidirectional &) = delete;
+	Bidirectional &operator=(const Bidirectional &) = delete;
+
+	//Returns false when the end can't be reached
+	bool findPath(Position from, Position to);
+};
+
+#endif //BIDIRECTIONAL_H
@@ -0,0 +1,531 @@
+/*
+File Name : Cooperative.cpp
+Copyright  2018
+Original authors : Sanketh Bhat
+Written under the supervision of David I.Schwartz, Ph.D., and
+supported by a professional development seed grant from the B.Thomas
+Golisano College of Computing & Information Sciences
+(https ://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software : you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Cooperative pathfinding for many agents on one map (windowed hierarchical cooperative A*, WHCA*). Agents plan
+in space and time against a shared reservation table, so their routes don't run into each other.
+*/
+
+#include "Cooperative.h"
+
+static const float INF = std::numeric_limits<float>::infinity();
+
+#pragma region ReservationTable
+
+ReservationTable::ReservationTable(int capacity)
+{
+	size_t size = 16;
+	shift = 60;
+	while (size < (size_t)capacity * 2)
+	{
+		size *= 2;
+		shift--;
+	}
+	slots.assign(size, { EMPTY, -1, 0 });
+}
+
+const ReservationTable::Slot *ReservationTable::find(uint64_t key) const
+{
+	size_t mask = slots.size() - 1;
+	for (size_t i = home(key); slots[i].key != EMPTY; i = (i + 1) & mask)
+		if (slots[i].key == key)
+			return &slots[i];
+	return nullptr;
+}
+
+int ReservationTable::owner(int t, int unit) const
+{
+	if (const Slot *s = find(keyOf(t, unit)))
+		return s->agent;
+	const Slot *r = find(keyOf(REST, unit));
+	return r && r->from <= t ? r->agent : -1;
+}
+
+int ReservationTable::rester(int unit) const
+{
+	const Slot *s = find(keyOf(REST, unit));
+	return s ? s->agent : -1;
+}
+
+bool ReservationTable::reserve(int t, int unit, int agent)
+{
+	int o = owner(t, unit);
+	if (o != -1 && o != agent)
+		return false;
+	insert(keyOf(t, unit), agent, t);
+	return true;
+}
+
+bool ReservationTable::rest(int from, int unit, int agent)
+{
+	int o = rester(unit);
+	if (o != -1 && o != agent)
+		return false;
+	insert(keyOf(REST, unit), agent, from);
+	return true;
+}
+
+void ReservationTable::release(int t, int unit, int agent)
+{
+	erase(keyOf(t, unit), agent);
+}
+
+void ReservationTable::unrest(int unit, int agent)
+{
+	erase(keyOf(REST, unit), agent);
+}
+
+void ReservationTable::insert(uint64_t key, int agent, int from)
+{
+	if ((size_t)(count + 1) * 2 > slots.size())
+		grow();
+
+	size_t mask = slots.size() - 1;
+	size_t i = home(key);
+	while (slots[i].key != EMPTY && slots[i].key != key)
+		i = (i + 1) & mask;
+
+	if (slots[i].key == EMPTY)
+		count++;
+	slots[i] = { key, agent, from };
+}
+
+void ReservationTable::erase(uint64_t key, int agent)
+{
+	size_t mask = slots.size() - 1;
+	size_t i = home(key);
+	while (slots[i].key != key)
+	{
+		if (slots[i].key == EMPTY)
+			return;
+		i = (i + 1) & mask;
+	}
+	if (slots[i].agent != agent)
+		return;
+
+	//Backward shift instead of a tombstone: later entries of the same run move up into the gap
+	//unless they already sit between their home slot and it, so lookups never probe past dead slots
+	for (size_t j = (i + 1) & mask; slots[j].key != EMPTY; j = (j + 1) & mask)
+	{
+		size_t k = home(slots[j].key);
+		bool stays = i < j ? (k > i && k <= j) : (k > i || k <= j);
+		if (!stays)
+		{
+			slots[i] = slots[j];
+			i = j;
+		}
+	}
+	slots[i] = { EMPTY, -1, 0 };
+	count--;
+}
+
+void ReservationTable::grow()
+{
+	std::vector<Slot> old;
+	old.swap(slots);
+	slots.assign(old.size() * 2, { EMPTY, -1, 0 });
+	shift--;
+	count = 0;
+
+	for (const Slot &s : old)
+		if (s.key != EMPTY)
+			insert(s.key, s.agent, s.from);
+}
+
+void ReservationTable::clear()
+{
+	std::fill(slots.begin(), slots.end(), Slot{ EMPTY, -1, 0 });
+	count = 0;
+}
+
+#pragma endregion
+
+#pragma region Cooperative
+
+Cooperative::Cooperative(graph &map, int window) : map(map), window(std::max(1, window))
+{
+	moves = map.neighborhood;
+	map.addListener(this);
+}
+
+Cooperative::~Cooperative()
+{
+	map.removeListener(this);
+}
+
+void Cooperative::unitChanged(int x, int y)
+{
+	//An edit can shorten or lengthen any distance. Each goal's search notices the count changed and
+	//starts over when a plan next reads it.
+	edits++;
+}
+
+int Cooperative::addAgent(Position start, Position goal)
+{
+	int id = (int)agents.size();
+	agents.emplace_back();
+
+	Agent &a = agents.back();
+	a.unit = map.unitId(start.x, start.y);
+	a.goal = map.unitId(goal.x, goal.y);
+	a.plan.push_back(a.unit);
+	a.planStart = now;
+	reservations.reserve(now, a.unit, id);
+	reservations.rest(now, a.unit, id);
+
+	return id;
+}
+
+void Cooperative::setGoal(int id, Position goal)
+{
+	Agent &a = agents[id];
+	int g = map.unitId(goal.x, goal.y);
+	if (g == a.goal)
+		return;
+
+	if (a.distances)
+		dropGoal(a.distances);
+	a.goal = g;
+	a.distances = nullptr;
+	a.due = true;
+}
+
+void Cooperative::step()
+{
+	replanned = 0;
+	expanded = 0;
+	int interval = std::max(1, window / 2);
+
+	for (int id = 0; id < (int)agents.size(); id++)
+	{
+		Agent &a = agents[id];
+		int k = now - a.planStart;
+		bool usedUp = k + 1 >= (int)a.plan.size();
+		bool blocked = false;
+		if (!usedUp)
+		{
+			Position p = map.position(a.plan[k + 1]);
+			blocked = !map.passable(p.x, p.y);
+		}
+
+		if (a.due || usedUp || blocked || (now + id) % interval == 0)
+		{
+			if (moves == Neighborhood::four)
+				plan<FourNeighbors>(id);
+			else
+				plan<EightNeighbors>(id);
+			replanned++;
+		}
+	}
+
+	for (int id = 0; id < (int)agents.size(); id++)
+	{
+		Agent &a = agents[id];
+		int k = now - a.planStart;
+		reservations.release(now, a.plan[k], id);
+		if (k + 1 < (int)a.plan.size())
+			a.unit = a.plan[k + 1];
+	}
+
+	now++;
+}
+
+#pragma endregion
+
+#pragma region Goal distances
+
+Cooperative::GoalDistances *Cooperative::useGoal(int goal)
+{
+	auto g = goals.find(goal);
+	if (g == goals.end())
+	{
+		if ((int)goals.size() >= maxGoalTables)
+			return nullptr;
+
+		int n = map.width() * map.height();
+		GoalDistances *d = new GoalDistances();
+		d->goal = goal;
+		d->dist.resize(n);
+		d->stamp.assign(n, 0);
+		g = goals.emplace(goal, std::unique_ptr<GoalDistances>(d)).first;
+	}
+
+	g->second->users++;
+	return g->second.get();
+}
+
+void Cooperative::dropGoal(GoalDistances *d)
+{
+	if (--d->users == 0)
+		goals.erase(d->goal);
+}
+
+void Cooperative::restart(GoalDistances &d)
+{
+	d.edits = edits;
+	if (++d.generation == 1u << 31)
+	{
+		std::fill(d.stamp.begin(), d.stamp.end(), 0);
+		d.generation = 1;
+	}
+	d.open = std::priority_queue<OpenEntry>();
+
+	d.dist[d.goal] = 0;
+	d.stamp[d.goal] = d.generation * 2;
+	d.open.push({ 0, d.goal });
+}
+
+//Cost from a unit to the goal ignoring other agents, infinity when it can't be reached. The Dijkstra out from
+//the goal goes on until it closes the unit, and keeps its open list for the next unit asked about.
+//Like FlowField, blocked units get a cost so an agent left on one can step off, but nothing is reached through them.
+template<class N>
+float Cooperative::distance(GoalDistances &d, int unit)
+{
+	if (d.edits != edits)
+		restart(d);
+
+	uint32_t open = d.generation * 2;
+	uint32_t closed = open + 1;
+
+	while (d.stamp[unit] != closed && !d.open.empty())
+	{
+		int u = d.open.top().id;
+		d.open.pop();
+		if (d.stamp[u] == closed)
+			continue;
+		d.stamp[u] = closed;
+
+		Position p = map.position(u);
+		if (!map.passable(p.x, p.y))
+			continue;
+
+		for (int i = 0; i < N::count; i++)
+		{
+			int x = p.x + N::dx(i);
+			int y = p.y + N::dy(i);
+			if (x < 0 || x >= map.width() || y < 0 || y >= map.height())
+				continue;
+
+			int v = map.unitId(x, y);
+			if (d.stamp[v] == closed)
+				continue;
+
+			float nd = d.dist[u] + map.moveCost(u, v, N::cost(i));
+			if (d.stamp[v] != open || nd < d.dist[v])
+			{
+				d.stamp[v] = open;
+				d.dist[v] = nd;
+				d.open.push({ nd, v });
+			}
+		}
+	}
+
+	return d.stamp[unit] == closed ? d.dist[unit] : INF;
+}
+
+#pragma endregion
+
+#pragma region Space-time search
+
+int &Cooperative::stateSlot(int unit, int depth)
+{
+	uint64_t key = (uint64_t)depth << 32 | (uint32_t)unit;
+	size_t mask = stateKeys.size() - 1;
+	size_t i = (size_t)((key * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+
+	while (stateStamps[i] == stateGeneration)
+	{
+		if (stateKeys[i] == key)
+			return stateNodes[i];
+		i = (i + 1) & mask;
+	}
+
+	stateStamps[i] = stateGeneration;
+	stateKeys[i] = key;
+	stateNodes[i] = -1;
+	return stateNodes[i];
+}
+
+//Frees the agent's reservations from tick from on, and its rest
+void Cooperative::release(int id, int from)
+{
+	Agent &a = agents[id];
+	for (int k = std::max(0, from - a.planStart); k < (int)a.plan.size(); k++)
+		reservations.release(a.planStart + k, a.plan[k], id);
+	reservations.unrest(a.plan.back(), id);
+}
+
+//A* over (unit, tick) from where the agent is now to window ticks ahead. A state can be entered when no other
+//agent holds the unit at that tick and the move doesn't swap units with one. Waiting costs a straight move,
+//except on the goal, so an agent that has arrived stays put for free. The first state popped at the full depth
+//has the lowest cost so far plus distance left, and the route to it becomes the plan.
+//The agent rests where its plan ends, so a plan may only end on a unit nobody else needs from then on. When no
+//state the search reached can be held, the agent keeps the rest of its old plan, which the others planned around.
+template<class N>
+void Cooperative::plan(int id)
+{
+	Agent &a = agents[id];
+	kept.assign(a.plan.begin() + (now - a.planStart), a.plan.end());
+	release(id, now);
+	a.plan.clear();
+	a.planStart = now;
+	a.due = false;
+
+	//Goals get their tables when they are first planned for, and a freed table goes to the next goal without one
+	if (!a.distances)
+		a.distances = useGoal(a.goal);
+
+	//With the goal out of reach the agent rests where it is instead, only stepping aside to let others by.
+	//Without a table it can't tell, and plans with the octile estimate at the lowest weight on the map.
+	auto estimate = [&](int v) {
+		return a.distances ? distance<N>(*a.distances, v) : map.estimate(v, a.goal) * map.lowestWeight();
+	};
+	float h = estimate(a.unit);
+	bool lost = h == INF;
+	int rest = lost ? a.unit : a.goal;
+	if (lost)
+		h = 0;
+
+	//Every expansion makes at most N::count + 1 states, keep the state table at most half full
+	size_t needed = 2;
+	while (needed < (size_t)maxExpansions * (N::count + 1) * 2 + 2)
+		needed *= 2;
+	if (stateKeys.size() != needed)
+	{
+		stateKeys.assign(needed, 0);
+		stateNodes.assign(needed, -1);
+		stateStamps.assign(needed, 0);
+		stateGeneration = 0;
+	}
+	if (++stateGeneration == 0)
+	{
+		std::fill(stateStamps.begin(), stateStamps.end(), 0);
+		stateGeneration = 1;
+	}
+
+	nodes.clear();
+	open = std::priority_queue<OpenEntry>();
+
+	nodes.push_back({ a.unit, 0, 0, -1, false });
+	stateSlot(a.unit, 0) = 0;
+	open.push({ h, 0 });
+
+	//Whether the agent can stay on the unit from the state's tick on. Other plans reach no further than now + window.
+	auto holdable = [&](const Node &n) {
+		int o = reservations.rester(n.unit);
+		if (o != -1 && o != id)
+			return false;
+		for (int t = now + n.depth + 1; t <= now + window; t++)
+		{
+			o = reservations.owner(t, n.unit);
+			if (o != -1 && o != id)
+				return false;
+		}
+		return true;
+	};
+
+	int best = -1; //Deepest state that can be held
+	int expansions = 0;
+	while (!open.empty())
+	{
+		int ni = open.top().id;
+		open.pop();
+		if (nodes[ni].closed)
+			continue;
+
+		nodes[ni].closed = true;
+		expansions++;
+
+		Node n = nodes[ni];
+		if ((best == -1 || n.depth > nodes[best].depth) && holdable(n))
+			best = ni;
+		if ((n.depth == window && best == ni) || expansions >= maxExpansions)
+			break;
+		if (n.depth == window)
+			continue;
+
+		int t = now + n.depth;
+		Position p = map.position(n.unit);
+
+		//i == -1 is the wait
+		for (int i = -1; i < N::count; i++)
+		{
+			int v = n.unit;
+			float cost = n.unit == rest ? 0 : STRAIGHT_COST;
+			if (i >= 0)
+			{
+				int x = p.x + N::dx(i);
+				int y = p.y + N::dy(i);
+				if (!map.passable(x, y))
+					continue;
+				v = map.unitId(x, y);
+				cost = map.moveCost(n.unit, v, N::cost(i));
+			}
+
+			int o = reservations.owner(t + 1, v);
+			if (o != -1 && o != id)
+				continue;
+			if (i >= 0)
+			{
+				o = reservations.owner(t, v);
+				if (o != -1 && o != id && reservations.owner(t + 1, n.unit) == o)
+					continue;
+			}
+
+			float hv = lost ? 0 : estimate(v);
+			if (hv == INF)
+				continue;
+
+			float ng = n.g + cost;
+			int &slot = stateSlot(v, n.depth + 1);
+			if (slot == -1)
+			{
+				slot = (int)nodes.size();
+				nodes.push_back({ v, n.depth + 1, ng, ni, false });
+				open.push({ ng + hv, slot });
+			}
+			else if (!nodes[slot].closed && ng < nodes[slot].g)
+			{
+				nodes[slot].g = ng;
+				nodes[slot].parent = ni;
+				open.push({ ng + hv, slot });
+			}
+		}
+	}
+	expanded += expansions;
+
+	if (best == -1)
+		a.plan.swap(kept);
+	else
+	{
+		a.plan.resize(nodes[best].depth + 1);
+		for (int i = best; i != -1; i = nodes[i].parent)
+			a.plan[nodes[i].depth] = nodes[i].unit;
+	}
+
+	//The search only entered free states, so none of these are refused
+	for (int k = 0; k < (int)a.plan.size(); k++)
+		reservations.reserve(now + k, a.plan[k], id);
+	reservations.rest(now + (int)a.plan.size() - 1, a.plan.back(), id);
+}
+
+#pragma endregion
@@ -0,0 +1,176 @@
+/*
+File Name : Cooperative.h
+Copyright  2018
+Original authors : Sanketh Bhat
+Written under the supervision of David I.Schwartz, Ph.D., and
+supported by a professional development seed grant from the B.Thomas
+Golisano College of Computing & Information Sciences
+(https ://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software : you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Cooperative pathfinding for many agents on one map (windowed hierarchical cooperative A*, WHCA*). Agents plan
+in space and time against a shared reservation table, so their routes don't run into each other.
+*/
+
+#ifndef COOPERATIVE_H
+#define COOPERATIVE_H
+
+#include <memory>
+#include <unordered_map>
+
+#include "graph.h"
+
+//Which agent holds each unit at each tick. Open addressing with linear probing in one flat array kept at most
+//half full, so 1000 agents with a window of 16 need about 17000 entries and 1 MB of slots.
+//Entries are removed as time passes and when an agent replans, so it only ever holds the ticks ahead.
+//Besides single ticks an agent can rest on a unit, holding it from a tick on until the rest is taken back,
+//which is how an agent keeps the unit its plan ends on past the window.
+class ReservationTable {
+
+	struct Slot {
+		uint64_t key; //tick in the high 32 bits, unit id in the low
+		int agent;
+		int from; //First tick held, for rests
+	};
+
+	static const uint64_t EMPTY = ~(uint64_t)0;
+	static const int REST = -1; //Tick rests are kept under
+
+	std::vector<Slot> slots; //Size is a power of two
+	int shift; //64 - log2 of the size, for Fibonacci hashing
+	int count = 0;
+
+	static uint64_t keyOf(int t, int unit) { return (uint64_t)(uint32_t)t << 32 | (uint32_t)unit; }
+	size_t home(uint64_t key) const { return (size_t)((key * 0x9E3779B97F4A7C15ull) >> shift); }
+	const Slot *find(uint64_t key) const;
+	void insert(uint64_t key, int agent, int from);
+	void erase(uint64_t key, int agent);
+	void grow();
+
+public:
+	ReservationTable(int capacity = 1024);
+
+	int owner(int t, int unit) const; //Agent holding the unit at tick t, -1 for none
+	int rester(int unit) const; //Agent resting on the unit, -1 for none
+	bool reserve(int t, int unit, int agent); //False, leaving it as it was, when another agent holds the unit then
+	bool rest(int from, int unit, int agent); //False when another agent rests on the unit
+	void release(int t, int unit, int agent); //Only if agent still holds it
+	void unrest(int unit, int agent); //Only if agent still rests on it
+	void clear();
+	int size() const { return count; }
+};
+
+//Moves agents one unit per tick without collisions. Each agent plans window ticks ahead with A* over
+//(unit, tick), where waiting in place is a move too, and reserves the units of its plan. Agents that plan later
+//route around the reservations of the ones before them, neither two agents in one unit nor two swapping units.
+//Plans are redone every window / 2 ticks, staggered by agent id, so each step replans only a share of the agents.
+//The heuristic is the true distance to the goal around obstacles, ignoring other agents, worked out
+//by a Dijkstra out from each goal that only runs as far as the units asked about (Reverse Resumable A*).
+//Agents with the same goal share it. Each of these tables takes 8 bytes per map unit, so only maxGoalTables
+//goals get one, in the order agents first plan for them; the agents of any other goal plan with the octile
+//estimate until a table is freed. Registers itself with the graph, and after an edit each table starts
+//over the next time a plan reads it, once however many edits came before.
+class Cooperative : public MapListener {
+
+	//Dijkstra out from one goal, resumed whenever a unit it hasn't reached yet is asked about.
+	//dist only holds values where stamp matches the generation, so starting over doesn't sweep the map.
+	struct GoalDistances {
+		int goal;
+		int users = 0; //Agents heading to the goal
+		int edits = -1; //Map edits seen when the search started
+		uint32_t generation = 0;
+		std::vector<float> dist;
+		std::vector<uint32_t> stamp; //generation * 2, plus 1 once the unit is closed
+		std::priority_queue<OpenEntry> open; //Units can be in it more than once, all but the cheapest are skipped
+	};
+
+	struct Agent {
+		int unit;
+		int goal;
+		std::vector<int> plan; //Unit at each tick from planStart on, plan[0] is where the agent was when it planned.
+		                       //The agent rests on plan.back() from the tick it gets there.
+		int planStart = 0;
+		bool due = true; //Replans on the next step whatever the schedule
+		GoalDistances *distances = nullptr; //Null while the goal has no table
+	};
+
+	//One (unit, tick) state of the space-time search
+	struct Node {
+		int unit;
+		int depth; //Ticks after the search started
+		float g;
+		int parent; //Node index, -1 for the first
+		bool closed;
+	};
+
+	graph &map;
+	int window;
+	Neighborhood moves; //Neighborhood read when the planner was made
+	int now = 0;
+	int edits = 0; //Map edits so far
+
+	std::vector<Agent> agents;
+	std::unordered_map<int, std::unique_ptr<GoalDistances>> goals;
+	ReservationTable reservations;
+
+	//Space-time search data, reused by every plan. States are found through an open addressing table
+	//of node indices, stamped per search so starting one doesn't sweep it.
+	std::vector<Node> nodes;
+	std::vector<int> kept; //Rest of the plan being redone
+	std::priority_queue<OpenEntry> open;
+	std::vector<uint64_t> stateKeys;
+	std::vector<int> stateNodes;
+	std::vector<uint32_t> stateStamps;
+	uint32_t stateGeneration = 0;
+
+	GoalDistances *useGoal(int goal); //Null when the goal has no table and maxGoalTables are in use
+	void dropGoal(GoalDistances *d);
+	void restart(GoalDistances &d);
+	template<class N>
+	float distance(GoalDistances &d, int unit);
+
+	int &stateSlot(int unit, int depth); //Node index of a state, -1 when the search hasn't reached it
+	void release(int id, int from);
+	template<class N>
+	void plan(int id);
+
+public:
+	int maxExpansions = 1024; //Per plan. A plan cut short ends at the deepest state reached and is redone once used up.
+	int maxGoalTables = 32; //Goals with a true distance table, 8 bytes per map unit each
+	int replanned = 0; //Agents the last step replanned
+	int expanded = 0; //States those plans expanded
+
+	Cooperative(graph &map, int window = 16);
+	~Cooperative();
+	Cooperative(const Cooperative &) = delete;
+	Cooperative &operator=(const Cooperative &) = delete;
+
+	void unitChanged(int x, int y) override;
+
+	int addAgent(Position start, Position goal); //Returns the agent's id, it plans on the next step. Start must be free.
+	void setGoal(int id, Position goal);
+
+	//Replans the agents that are due, then moves every agent one tick along its plan
+	void step();
+
+	int agentCount() const { return (int)agents.size(); }
+	int time() const { return now; }
+	Position position(int id) const { return map.position(agents[id].unit); }
+	bool arrived(int id) const { return agents[id].unit == agents[id].goal; }
+	int reserved() const { return reservations.size(); }
+};
+
+#endif //COOPERATIVE_H
@@ -0,0 +1,264 @@
+/*
+File Name : FlowField.cpp
+Copyright  2018
+Original authors : Sanketh Bhat
+Written under the supervision of David I.Schwartz, Ph.D., and
+supported by a professional development seed grant from the B.Thomas
+Golisano College of Computing & Information Sciences
+(https ://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software : you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.If not, see <http://www.gnu.org/licenses/>.
+
+
+Description:
+Flow field for many agents heading to one goal. One Dijkstra out from the goal gives every unit its cost
+to the goal and the neighbor to step to, so each agent finds its next move with one lookup.
+*/
+
+#include "FlowField.h"
+
+static const float INF = std::numeric_limits<float>::infinity();
+
+FlowField::FlowField(graph &map, Position goal) : map(map)
+{
+	setGoal(goal);
+	map.addListener(this);
+}
+
+FlowField::~FlowField()
+{
+	map.removeListener(this);
+}
+
+void FlowField::setGoal(Position p)
+{
+	goal = map.unitId(p.x, p.y);
+	moves = map.neighborhood;
+	changed.clear();
+
+	if (moves == Neighborhood::four)
+		build<FourNeighbors>();
+	else
+		build<EightNeighbors>();
+}
+
+void FlowField::unitChanged(int x, int y)
+{
+	changed.push_back(map.unitId(x, y));
+}
+
+Position FlowField::next(Position p) const
+{
+	int n = next(map.unitId(p.x, p.y));
+	return n == -1 ? p : map.position(n);
+}
+
+void FlowField::update()
+{
+	if (moves == Neighborhood::four)
+		update<FourNeighbors>();
+	else
+		update<EightNeighbors>();
+}
+
+template<class N>
+void FlowField::build()
+{
+	int n = map.width() * map.height();
+
+	for (int i = 0; i < N::count; i++)
+		offset[i] = N::dx(i) + N::dy(i) * map.width();
+
+	dist.assign(n, INF);
+	step.assign(n, -1);
+	open.resize(n);
+	touched.clear();
+
+	dist[goal] = 0;
+	open.push(goal, 0);
+	propagate<N>();
+
+	for (int u = 0; u < n; u++)
+		pickStep<N>(u);
+	touched.clear();
+}
+
+//Dijkstra from the units already in the open list, lowering costs only. Blocked units get a cost,
+//since an agent standing on one can still step off it, but nothing is reached through them.
+template<class N>
+void FlowField::propagate()
+{
+	while (!open.empty())
+	{
+		int u = open.top().id;
+		open.pop();
+		touched.push_back(u);
+
+		Position p = map.position(u);
+		if (!map.passable(p.x, p.y))
+			continue;
+
+		for (int i = 0; i < N::count; i++)
+		{
+			int x = p.x + N::dx(i);
+			int y = p.y + N::dy(i);
+			if (x < 0 || x >= map.width() || y < 0 || y >= map.height())
+				continue;
+
+			int n = map.unitId(x, y);
+			float nd = dist[u] + map.moveCost(u, n, N::cost(i));
+			if (nd < dist[n])
+			{
+				dist[n] = nd;
+				if (open.contains(n))
+					open.decreaseKey(n, nd);
+				else
+					open.push(n, nd);
+			}
+		}
+	}
+}
+
+//Points u at its cheapest open neighbor. Ties keep the first direction, the same as a fresh build.
+template<class N>
+void FlowField::pickStep(int u)
+{
+	step[u] = -1;
+	if (u == goal || dist[u] == INF)
+		return;
+
+	Position p = map.position(u);
+	float best = INF;
+
+	for (int i = 0; i < N::count; i++)
+	{
+		int x = p.x + N::dx(i);
+		int y = p.y + N::dy(i);
+		if (!map.passable(x, y))
+			continue;
+
+		int n = map.unitId(x, y);
+		float d = map.moveCost(u, n, N::cost(i)) + dist[n];
+		if (d < best)
+		{
+			best = d;
+			step[u] = (int8_t)i;
+		}
+	}
+}
+
+//Repairs the field after the edits in changed, all at once so the steps it starts from are still those
+//of the last update and agree with the costs.
+//An edit changes the cost of every move into or out of the edited unit, so the unit and everything whose steps
+//lead into it are forgotten and filled in again from the units around them. Every other unit keeps a route that
+//doesn't touch an edited unit, and its cost can only go down from there, so after that a single Dijkstra from
+//the refilled units brings every cost up to date.
+template<class N>
+void FlowField::update()
+{
+	std::vector<int> lost;
+	touched.clear();
+
+	for (int v : changed)
+	{
+		//The goal keeps its cost of 0, only the units stepping into it are redone. It goes back in the open list,
+		//since after it was blocked nothing else may be left to spread its cost again.
+		size_t k = lost.size();
+		if (v != goal)
+		{
+			step[v] = -1;
+			dist[v] = INF;
+			lost.push_back(v);
+			k++;
+		}
+		else
+		{
+			touched.push_back(v);
+			if (!open.contains(goal))
+				open.push(goal, 0);
+		}
+
+		//Everything whose steps pass through v
+		for (int u = v;; u = lost[k++])
+		{
+			Position p = map.position(u);
+
+			for (int i = 0; i < N::count; i++)
+			{
+				int x = p.x - N::dx(i);
+				int y = p.y - N::dy(i);
+				if (x < 0 || x >= map.width() || y < 0 || y >= map.height())
+					continue;
+
+				int n = map.unitId(x, y);
+				if (step[n] == i)
+				{
+					step[n] = -1;
+					dist[n] = INF;
+					lost.push_back(n);
+				}
+			}
+
+			if (k == lost.size())
+				break;
+		}
+	}
+	changed.clear();
+
+	for (int u : lost)
+	{
+		touched.push_back(u);
+		Position p = map.position(u);
+
+		for (int i = 0; i < N::count; i++)
+		{
+			int x = p.x + N::dx(i);
+			int y = p.y + N::dy(i);
+			if (!map.passable(x, y))
+				continue;
+
+			int n = map.unitId(x, y);
+			float d = map.moveCost(u, n, N::cost(i)) + dist[n];
+			if (d < dist[u])
+				dist[u] = d;
+		}
+
+		if (dist[u] != INF)
+		{
+			if (open.contains(u))
+				open.decreaseKey(u, dist[u]);
+			else
+				open.push(u, dist[u]);
+		}
+	}
+
+	propagate<N>();
+
+	//A unit's step depends on its neighbors' costs, so the neighbors of every changed unit are checked too
+	updated = (int)touched.size();
+	for (int u : touched)
+	{
+		Position p = map.position(u);
+		pickStep<N>(u);
+
+		for (int i = 0; i < N::count; i++)
+		{
+			int x = p.x + N::dx(i);
+			int y = p.y + N::dy(i);
+			if (x >= 0 && x < map.width() && y >= 0 && y < map.height())
+				pickStep<N>(map.unitId(x, y));
+		}
+	}
+	touched.clear();
+}
@@ -0,0 +1,79 @@
+/*
+File Name : FlowField.h
+Copyright  2018
+Original authors : Sanketh Bhat
+Written under the supervision of David I.Schwartz, Ph.D., and
+supported by a professional development seed grant from the B.Thomas
+Golisano College of Computing & Information Sciences
+(https ://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software : you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.If not, see <http://www.gnu.org/licenses/>.
+
+
+Description:
+Flow field for many agents heading to one goal. One Dijkstra out from the goal gives every unit its cost
+to the goal and the neighbor to step to, so each agent finds its next move with one lookup.
+*/
+
+#ifndef FLOW_FIELD_H
+#define FLOW_FIELD_H
+
+#include "graph.h"
+
+//Registers itself with the graph and notes every edit. update() then repairs only the units whose cost
+//the edits changed, so call it once per frame after the edits and before agents read their next steps.
+class FlowField : public MapListener {
+
+	graph &map;
+	int goal;
+	Neighborhood moves; //Neighborhood the field was built with
+
+	std::vector<float> dist; //Cost from each unit to the goal, infinity when it can't reach it
+	std::vector<int8_t> step; //Direction to move in from each unit, -1 at the goal and where the goal can't be reached
+	int offset[dir]; //Change of unit id for each direction
+
+	BucketQueue open;
+	std::vector<int> touched; //Units whose cost changed during the current repair
+	std::vector<int> changed; //Units edited since the last update
+
+	template<class N>
+	void build();
+	template<class N>
+	void propagate();
+	template<class N>
+	void pickStep(int u);
+	template<class N>
+	void update();
+
+public:
+	int updated = 0; //Units whose cost the last update recomputed
+
+	FlowField(graph &map, Position goal);
+	~FlowField();
+	FlowField(const FlowField &) = delete;
+	FlowField &operator=(const FlowField &) = delete;
+
+	void setGoal(Position goal); //Rebuilds the whole field, also picks up a change of the graph's neighborhood
+	void unitChanged(int x, int y) override;
+	void update(); //Repairs the field for every edit since the last call
+
+	float distance(int id) const { return dist[id]; }
+	float distance(Position p) const { return dist[map.unitId(p.x, p.y)]; }
+
+	//Unit to move to from id, -1 at the goal or when the goal can't be reached
+	int next(int id) const { return step[id] < 0 ? -1 : id + offset[step[id]]; }
+	Position next(Position p) const;
+};
+
+#endif //FLOW_FIELD_H
@@ -0,0 +1,538 @@
+/*
+File Name : Hierarchy.cpp
+Copyright  2018
+Original authors : Sanketh Bhat
+Written under the supervision of David I.Schwartz, Ph.D., and
+supported by a professional development seed grant from the B.Thomas
+Golisano College of Computing & Information Sciences
+(https ://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software : you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Hierarchical pathfinding (HPA*) over a graph. The map is split into square clusters,
+units where paths cross between clusters become nodes of a small abstract graph,
+and a query searches that graph first and then fills in the route one cluster at a time.
+*/
+
+#include "Hierarchy.h"
+
+Hierarchy::Hierarchy(graph &map, int clusterSize) : map(map), size(clusterSize)
+{
+	cw = (map.width() + size - 1) / size;
+	ch = (map.height() + size - 1) / size;
+
+	localDist.resize(size * size);
+	localParent.resize(size * size);
+	localOpen.resize(size * size);
+
+	build();
+	map.addListener(this);
+}
+
+Hierarchy::~Hierarchy()
+{
+	map.removeListener(this);
+}
+
+#pragma region Building
+
+void Hierarchy::build()
+{
+	clusters.assign(cw * ch, Cluster());
+	nodes.clear();
+	freeNodes.clear();
+	nodeOf.clear();
+
+	for (int c = 0; c < cw * ch; c++)
+		buildCluster(c);
+	for (int c = 0; c < cw * ch; c++)
+		resolveLinks(c);
+}
+
+//A unit only affects the links that cross the cluster edges and corners it sits on,
+//so besides its own cluster only the neighbors on the other side of those need rebuilding
+void Hierarchy::unitChanged(int x, int y)
+{
+	int c = clusterOf(map.unitId(x, y));
+	int cx = c % cw, cy = c / cw;
+	int x0, y0, x1, y1;
+	bounds(c, x0, y0, x1, y1);
+
+	int loX = (x == x0) ? -1 : 0, hiX = (x == x1 - 1) ? 1 : 0;
+	int loY = (y == y0) ? -1 : 0, hiY = (y == y1 - 1) ? 1 : 0;
+
+	//Links are only resolved once every cluster on both sides of them has its new nodes
+	for (int pass = 0; pass < 2; pass++)
+	{
+		for (int oy = loY; oy <= hiY; oy++)
+		{
+			for (int ox = loX; ox <= hiX; ox++)
+			{
+				int nx = cx + ox, ny = cy + oy;
+				if (nx < 0 || nx >= cw || ny < 0 || ny >= ch)
+					continue;
+
+				if (pass == 0)
+					buildCluster(ny * cw + nx);
+				else
+					resolveLinks(ny * cw + nx);
+			}
+		}
+	}
+}
+
+//Finds the links of cluster c, then the cost between each pair of its nodes
+void Hierarchy::buildCluster(int c)
+{
+	Cluster &cl = clusters[c];
+	int cx = c % cw, cy = c / cw;
+
+	cl.links.clear();
+	for (int oy = -1; oy <= 1; oy++)
+	{
+		for (int ox = -1; ox <= 1; ox++)
+		{
+			int nx = cx + ox, ny = cy + oy;
+			if ((ox != 0 || oy != 0) && nx >= 0 && nx < cw && ny >= 0 && ny < ch)
+				borderLinks(c, ny * cw + nx, cl.links);
+		}
+	}
+
+	std::stable_sort(cl.links.begin(), cl.links.end(), [](const Link &a, const Link &b) { return a.from < b.from; });
+
+	//Units that stay nodes keep their numbers, the numbers of units that no longer are go back on the free list
+	for (int id : cl.nodes)
+		nodes[id].cluster = -1;
+
+	std::vector<int> old;
+	old.swap(cl.nodes);
+	cl.firstLink.clear();
+
+	for (int k = 0; k < (int)cl.links.size(); k++)
+	{
+		int unit = cl.links[k].from;
+		if (k > 0 && cl.links[k - 1].from == unit)
+			continue;
+
+		auto found = nodeOf.find(unit);
+		int id;
+		if (found != nodeOf.end())
+			id = found->second;
+		else
+		{
+			if (freeNodes.empty())
+			{
+				id = (int)nodes.size();
+				nodes.push_back(Node());
+			}
+			else
+			{
+				id = freeNodes.back();
+				freeNodes.pop_back();
+			}
+			nodeOf[unit] = id;
+		}
+
+		nodes[id] = { unit, c, (int)cl.nodes.size() };
+		cl.nodes.push_back(id);
+		cl.firstLink.push_back(k);
+	}
+	cl.firstLink.push_back((int)cl.links.size());
+
+	for (int id : old)
+	{
+		if (nodes[id].cluster == -1)
+		{
+			nodeOf.erase(nodes[id].unit);
+			nodes[id].unit = -1;
+			freeNodes.push_back(id);
+		}
+	}
+
+	int n = (int)cl.nodes.size();
+	cl.dist.assign(n * n, std::numeric_limits<float>::infinity());
+
+	for (int i = 0; i < n; i++)
+	{
+		searchCluster(c, nodes[cl.nodes[i]].unit, -1);
+		for (int j = 0; j < n; j++)
+			cl.dist[i * n + j] = localCost(c, nodes[cl.nodes[j]].unit);
+	}
+}
+
+//Looks up the node each link of cluster c leads to. Every link has a twin going back the other way,
+//so the unit it leads to is always a node of the neighbor.
+void Hierarchy::resolveLinks(int c)
+{
+	for (Link &l : clusters[c].links)
+		l.node = nodeOf[l.to];
+}
+
+//Adds the links from cluster c into its neighbor n. Both clusters walk their shared edge in the
+//same order, so borderLinks(n, c) finds exactly the same crossings in the other direction.
+void Hierarchy::borderLinks(int c, int n, std::vector<Link> &links) const
+{
+	int x0, y0, x1, y1;
+	bounds(c, x0, y0, x1, y1);
+
+	int ox = n % cw - c % cw;	//Direction from c to n
+	int oy = n / cw - c / cw;
+
+	//Corner neighbor: the only crossing is the diagonal between the two corner units
+	if (ox != 0 && oy != 0)
+	{
+		int ax = ox > 0 ? x1 - 1 : x0;
+		int ay = oy > 0 ? y1 - 1 : y0;
+		addSqueeze(links, ax, ay, ax + ox, ay + oy);
+		return;
+	}
+
+	//Shared edge: (ax, ay) is the first unit of c along it and (ex, ey) the step along it
+	int ax, ay, ex, ey, length;
+	if (ox != 0)
+	{
+		ax = ox > 0 ? x1 - 1 : x0;
+		ay = y0;
+		ex = 0;
+		ey = 1;
+		length = y1 - y0;
+	}
+	else
+	{
+		ax = x0;
+		ay = oy > 0 ? y1 - 1 : y0;
+		ex = 1;
+		ey = 0;
+		length = x1 - x0;
+	}
+
+	int runStart = -1;
+	for (int t = 0; t <= length; t++)
+	{
+		int x = ax + ex * t;
+		int y = ay + ey * t;
+
+		//Straight crossings are grouped into runs of open units on both sides
+		bool open = t < length && map.passable(x, y) && map.passable(x + ox, y + oy);
+		if (open && runStart == -1)
+			runStart = t;
+		if (!open && runStart != -1)
+		{
+			addRun(links, ax, ay, ex, ey, ox, oy, runStart, t - 1);
+			runStart = -1;
+		}
+
+		//Diagonal crossings between this unit and the next one along the edge
+		if (t + 1 < length)
+		{
+			addSqueeze(links, x, y, x + ex + ox, y + ey + oy);
+			addSqueeze(links, x + ex, y + ey, x + ox, y + oy);
+		}
+	}
+}
+
+//Links a run of open straight crossings, from step first to step last along the edge
+void Hierarchy::addRun(std::vector<Link> &links, int ax, int ay, int ex, int ey, int ox, int oy, int first, int last) const
+{
+	int length = last - first + 1;
+	int steps[2] = { first + length / 2, -1 };
+
+	if (length >= ENTRANCE_SPLIT)
+	{
+		steps[0] = first;
+		steps[1] = last;
+	}
+
+	for (int t : steps)
+	{
+		if (t == -1)
+			continue;
+
+		int x = ax + ex * t;
+		int y = ay + ey * t;
+		int a = map.unitId(x, y);
+		int b = map.unitId(x + ox, y + oy);
+		links.push_back({ a, b, map.moveCost(a, b, STRAIGHT_COST), -1 });
+	}
+}
+
+//Links a diagonal move from a to b when both units beside it are blocked. If either were open,
+//a straight crossing next to it would already connect the same areas.
+void Hierarchy::addSqueeze(std::vector<Link> &links, int ax, int ay, int bx, int by) const
+{
+	if (map.passable(ax, ay) && map.passable(bx, by) &&
+		!map.passable(bx, ay) && !map.passable(ax, by))
+	{
+		int a = map.unitId(ax, ay);
+		int b = map.unitId(bx, by);
+		links.push_back({ a, b, map.moveCost(a, b, DIAGONAL_COST), -1 });
+	}
+}
+
+#pragma endregion
+
+#pragma region Searching
+
+//Searches the abstract graph, with the start and end joined to the nodes of their clusters,
+//then refines the abstract route into units. Returns false when there is no route.
+bool Hierarchy::findPath(Position from, Position to)
+{
+	path.clear();
+	pathCost = 0;
+
+	if (!map.passable(from.x, from.y) || !map.passable(to.x, to.y))
+		return false;
+
+	int s = map.unitId(from.x, from.y);
+	int t = map.unitId(to.x, to.y);
+	int cs = clusterOf(s);
+	int ct = clusterOf(t);
+
+	//Costs from the start and from the end to the nodes of their clusters
+	searchCluster(ct, t, -1);
+	std::vector<float> goalDist;
+	for (int node : clusters[ct].nodes)
+		goalDist.push_back(localCost(ct, nodes[node].unit));
+
+	searchCluster(cs, s, -1);
+	std::vector<float> startDist;
+	for (int node : clusters[cs].nodes)
+		startDist.push_back(localCost(cs, nodes[node].unit));
+	float direct = (cs == ct) ? localCost(cs, t) : std::numeric_limits<float>::infinity();
+
+	//The node table only grows, so the context is only reallocated when new numbers were handed out
+	startSlot = (int)nodes.size();
+	int goalSlot = startSlot + 1;
+	startUnit = s;
+	goalUnit = t;
+
+	abstract.resize(startSlot + 2);
+	abstract.newSearch();
+	abstract.start = startSlot;
+	abstract.goal = goalSlot;
+
+	IndexedHeap &open = abstract.openHeap;
+	open.clear();
+	abstract.stamp[startSlot] = abstract.generation;
+	abstract.list[startSlot] = ListStatus::open;
+	abstract.g[startSlot] = 0;
+	abstract.parent[startSlot] = -1;
+	open.push(startSlot, map.estimate(s, t));
+
+	while (!open.empty())
+	{
+		int u = open.top().id;
+		open.pop();
+		abstract.list[u] = ListStatus::closed;
+
+		if (u == goalSlot)
+		{
+			open.clear();
+			break;
+		}
+
+		float g = abstract.g[u];
+
+		//The start only leads to the nodes of its cluster, which include its own unit if it is a node
+		if (u == startSlot)
+		{
+			const Cluster &cl = clusters[cs];
+			for (int j = 0; j < (int)cl.nodes.size(); j++)
+				relaxAbstract(u, cl.nodes[j], g + startDist[j], t);
+			relaxAbstract(u, goalSlot, g + direct, t);
+			continue;
+		}
+
+		int c = nodes[u].cluster;
+		int i = nodes[u].index;
+		const Cluster &cl = clusters[c];
+		int n = (int)cl.nodes.size();
+
+		//Inside the cluster
+		for (int j = 0; j < n; j++)
+			relaxAbstract(u, cl.nodes[j], g + cl.dist[i * n + j], t);
+		if (c == ct)
+			relaxAbstract(u, goalSlot, g + goalDist[i], t);
+
+		//Across to the neighboring clusters
+		for (int k = cl.firstLink[i]; k < cl.firstLink[i + 1]; k++)
+			relaxAbstract(u, cl.links[k].node, g + cl.links[k].cost, t);
+	}
+
+	if (abstract.listStatus(goalSlot) != ListStatus::closed)
+		return false;
+
+	pathCost = abstract.g[goalSlot];
+	refine(goalSlot);
+	return true;
+}
+
+//n and u are node numbers or the start and end slots, goal is the unit of the end
+void Hierarchy::relaxAbstract(int u, int n, float ng, int goal)
+{
+	if (n == u || ng == std::numeric_limits<float>::infinity())
+		return;
+
+	ListStatus l = abstract.listStatus(n);
+	if (l == ListStatus::closed)
+		return;
+
+	if (l != ListStatus::open)
+	{
+		abstract.stamp[n] = abstract.generation;
+		abstract.list[n] = ListStatus::open;
+		abstract.g[n] = ng;
+		abstract.parent[n] = u;
+		abstract.openHeap.push(n, ng + map.estimate(unitOf(n), goal));
+	}
+	else if (ng < abstract.g[n])
+	{
+		abstract.g[n] = ng;
+		abstract.parent[n] = u;
+		abstract.openHeap.decreaseKey(n, ng + map.estimate(unitOf(n), goal));
+	}
+}
+
+//Turns the abstract route ending at goal into units. Links are single moves,
+//every other hop stays inside one cluster and is searched again there.
+void Hierarchy::refine(int goal)
+{
+	std::vector<int> hops;
+	for (int k = goal; k != -1; k = abstract.parent[k])
+		hops.push_back(unitOf(k));
+	std::reverse(hops.begin(), hops.end());
+
+	path.push_back(hops[0]);
+
+	std::vector<int> segment;
+	for (size_t i = 1; i < hops.size(); i++)
+	{
+		int a = hops[i - 1];
+		int b = hops[i];
+		int c = clusterOf(a);
+
+		if (c != clusterOf(b))
+		{
+			path.push_back(b);
+			continue;
+		}
+
+		searchCluster(c, a, b);
+
+		int x0, y0, x1, y1;
+		bounds(c, x0, y0, x1, y1);
+
+		segment.clear();
+		Position p = map.position(b);
+		for (int id = (p.x - x0) + (p.y - y0) * size; id != -1; id = localParent[id])
+		{
+			int q = map.unitId(x0 + id % size, y0 + id / size);
+			if (q == a)
+				break;
+			segment.push_back(q);
+		}
+		path.insert(path.end(), segment.rbegin(), segment.rend());
+	}
+}
+
+//Dijkstra from unit `from` without leaving cluster c. Stops once `to` is reached, -1 searches the whole cluster.
+void Hierarchy::searchCluster(int c, int from, int to)
+{
+	int x0, y0, x1, y1;
+	bounds(c, x0, y0, x1, y1);
+
+	std::fill(localDist.begin(), localDist.end(), std::numeric_limits<float>::infinity());
+	localOpen.clear();
+
+	Position p = map.position(from);
+	int start = (p.x - x0) + (p.y - y0) * size;
+	localDist[start] = 0;
+	localParent[start] = -1;
+	localOpen.push(start, 0);
+
+	int target = -1;
+	if (to != -1)
+	{
+		Position q = map.position(to);
+		target = (q.x - x0) + (q.y - y0) * size;
+	}
+
+	while (!localOpen.empty())
+	{
+		int u = localOpen.top().id;
+		localOpen.pop();
+
+		if (u == target)
+			break;
+
+		int ux = x0 + u % size;
+		int uy = y0 + u / size;
+
+		for (int i = 0; i < dir; i++)
+		{
+			int x = ux + dx[i];
+			int y = uy + dy[i];
+
+			if (x < x0 || x >= x1 || y < y0 || y >= y1 || !map.passable(x, y))
+				continue;
+
+			int n = (x - x0) + (y - y0) * size;
+			float ng = localDist[u] + map.moveCost(map.unitId(ux, uy), map.unitId(x, y), dc[i]);
+
+			if (ng < localDist[n])
+			{
+				bool queued = localOpen.contains(n);
+				localDist[n] = ng;
+				localParent[n] = u;
+
+				if (queued)
+					localOpen.decreaseKey(n, ng);
+				else
+					localOpen.push(n, ng);
+			}
+		}
+	}
+}
+
+//Cost of a unit in cluster c found by the last searchCluster
+float Hierarchy::localCost(int c, int unit) const
+{
+	int x0, y0, x1, y1;
+	bounds(c, x0, y0, x1, y1);
+
+	Position p = map.position(unit);
+	return localDist[(p.x - x0) + (p.y - y0) * size];
+}
+
+#pragma endregion
+
+#pragma region Helper Methods
+
+int Hierarchy::clusterOf(int unit) const
+{
+	Position p = map.position(unit);
+	return (p.y / size) * cw + p.x / size;
+}
+
+//Units [x0, x1) x [y0, y1) belong to cluster c. Clusters on the right and bottom edges may be smaller.
+void Hierarchy::bounds(int c, int &x0, int &y0, int &x1, int &y1) const
+{
+	x0 = (c % cw) * size;
+	y0 = (c / cw) * size;
+	x1 = std::min(x0 + size, map.width());
+	y1 = std::min(y0 + size, map.height());
+}
+
+#pragma endregion
@@ -0,0 +1,116 @@
+/*
+File Name : Hierarchy.h
+Copyright  2018
+Original authors : Sanketh Bhat
+Written under the supervision of David I.Schwartz, Ph.D., and
+supported by a professional development seed grant from the B.Thomas
+Golisano College of Computing & Information Sciences
+(https ://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software : you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Hierarchical pathfinding (HPA*) over a graph. The map is split into square clusters,
+units where paths cross between clusters become nodes of a small abstract graph,
+and a query searches that graph first and then fills in the route one cluster at a time.
+*/
+
+#ifndef HIERARCHY_H
+#define HIERARCHY_H
+
+#include <unordered_map>
+
+#include "graph.h"
+
+//Runs shorter than this get one crossing in the middle, longer ones get one at each end
+const int ENTRANCE_SPLIT = 6;
+
+//Registers itself with the graph, so it rebuilds the clusters an edit touches on its own
+class Hierarchy : public MapListener {
+
+	//A move between two units in neighboring clusters
+	struct Link {
+		int from;
+		int to;
+		float cost;
+		int node; //Node number of to, filled in once the clusters on both sides are built
+	};
+
+	struct Cluster {
+		std::vector<int> nodes; //Node numbers of the units of this cluster that links start from, in unit order
+		std::vector<float> dist; //Cost between each pair of nodes without leaving the cluster, nodes.size() squared
+		std::vector<Link> links; //Every link leaving this cluster, grouped by the node they start from
+		std::vector<int> firstLink; //Links of the i-th node are [firstLink[i], firstLink[i + 1])
+	};
+
+	//Entrance nodes, numbered so the abstract search needs memory for nodes rather than for map units.
+	//A unit keeps its number for as long as it stays a node, so links from clusters that weren't rebuilt stay valid.
+	//Numbers freed by a rebuild are handed out again.
+	struct Node {
+		int unit; //-1 while the number is free
+		int cluster;
+		int index; //Position in the cluster's nodes
+	};
+
+	graph &map;
+	int size; //Side of a cluster in units
+	int cw, ch; //Clusters across and down
+	std::vector<Cluster> clusters;
+	std::vector<Node> nodes;
+	std::vector<int> freeNodes;
+	std::unordered_map<int, int> nodeOf; //Node number of each unit that is a node, only used while building
+
+	//Dijkstra inside one cluster, indexed by position in the cluster
+	std::vector<float> localDist;
+	std::vector<int> localParent;
+	IndexedHeap localOpen;
+
+	//A* over the abstract graph, indexed by node number. The two numbers after the last node stand for the
+	//start and the end of the query, which usually aren't nodes.
+	SearchContext abstract;
+	int startSlot = 0;
+	int startUnit = -1, goalUnit = -1;
+
+	int clusterOf(int unit) const;
+	void bounds(int c, int &x0, int &y0, int &x1, int &y1) const;
+	int unitOf(int k) const { return k == startSlot ? startUnit : k == startSlot + 1 ? goalUnit : nodes[k].unit; }
+
+	void borderLinks(int c, int n, std::vector<Link> &links) const;
+	void addRun(std::vector<Link> &links, int ax, int ay, int ex, int ey, int ox, int oy, int first, int last) const;
+	void addSqueeze(std::vector<Link> &links, int ax, int ay, int bx, int by) const;
+	void buildCluster(int c);
+	void resolveLinks(int c);
+
+	void searchCluster(int c, int from, int to);
+	float localCost(int c, int unit) const;
+	void relaxAbstract(int u, int n, float ng, int goal);
+	void refine(int goal);
+
+public:
+	std::vector<int> path; //Unit ids of the route of the last findPath, start and end included
+	float pathCost = 0;
+
+	Hierarchy(graph &map, int clusterSize = 16);
+	~Hierarchy();
+	Hierarchy(const Hierarchy &) = delete;
+	Hierarchy &operator=(const Hierarchy &) = delete;
+
+	void build(); //Rebuilds every cluster
+	void unitChanged(int x, int y) override; //Rebuilds only the clusters the unit can affect
+	bool findPath(Position from, Position to);
+
+	int clusterCount() const { return (int)clusters.size(); }
+};
+
+#endif //HIERARCHY_H
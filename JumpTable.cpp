@@ -0,0 +1,242 @@
+/*
+File Name : JumpTable.cpp
+Copyright  2018
+Original authors : Sanketh Bhat
+Written under the supervision of David I.Schwartz, Ph.D., and
+supported by a professional development seed grant from the B.Thomas
+Golisano College of Computing & Information Sciences
+(https ://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software : you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+JPS+ jump distances. For every unit and each of the 8 directions the table holds how far a jump from it
+goes, so Jump Point Search finds each successor with one lookup instead of stepping along the line.
+*/
+
+#include "JumpTable.h"
+
+//Index into the dx/dy tables of direction (ddx, ddy), at (ddy + 1) * 3 + ddx + 1
+static const int directionOf[9] = { 5, 6, 7, 4, -1, 0, 3, 2, 1 };
+
+JumpTable::JumpTable(graph &map) : map(map)
+{
+	map.addListener(this);
+}
+
+JumpTable::~JumpTable()
+{
+	map.removeListener(this);
+}
+
+bool JumpTable::build()
+{
+	w = map.width();
+	h = map.height();
+	dist.clear();
+
+	if (w > INT16_MAX || h > INT16_MAX)
+		return false;
+
+	dist.assign((size_t)w * h * dir, 0);
+
+	//Straight entries first, diagonal ones look at them
+	std::vector<int> changed;
+	for (int y = 0; y < h; y++)
+		sweepRow(y, changed);
+	for (int x = 0; x < w; x++)
+		sweepColumn(x, changed);
+
+	//Each diagonal entry reads the one a step on, so rows are filled from the far side back
+	for (int y = h - 1; y >= 0; y--)
+		for (int x = 0; x < w; x++)
+		{
+			at(x, y, 1) = entry(x, y, 1);
+			at(x, y, 3) = entry(x, y, 3);
+		}
+	for (int y = 0; y < h; y++)
+		for (int x = 0; x < w; x++)
+		{
+			at(x, y, 5) = entry(x, y, 5);
+			at(x, y, 7) = entry(x, y, 7);
+		}
+
+	return true;
+}
+
+//Whether a jump in direction i stops at (x, y) for a forced neighbor, the same tests as graph::jump
+bool JumpTable::forced(int x, int y, int i) const
+{
+	int ddx = dx[i], ddy = dy[i];
+
+	if (ddx != 0 && ddy != 0)
+		return (map.passable(x - ddx, y + ddy) && !map.passable(x - ddx, y)) ||
+			(map.passable(x + ddx, y - ddy) && !map.passable(x, y - ddy));
+	if (ddx != 0)
+		return (map.passable(x + ddx, y + 1) && !map.passable(x, y + 1)) ||
+			(map.passable(x + ddx, y - 1) && !map.passable(x, y - 1));
+	return (map.passable(x + 1, y + ddy) && !map.passable(x + 1, y)) ||
+		(map.passable(x - 1, y + ddy) && !map.passable(x - 1, y));
+}
+
+//Entry of (x, y) in direction i worked out from the unit one step on. A diagonal jump also stops where
+//either of its straight parts would find a jump point.
+int16_t JumpTable::entry(int x, int y, int i) const
+{
+	int nx = x + dx[i], ny = y + dy[i];
+	if (!map.passable(nx, ny))
+		return 0;
+
+	if (forced(nx, ny, i))
+		return 1;
+	if (dx[i] != 0 && dy[i] != 0 && (at(nx, ny, dx[i] > 0 ? 0 : 4) > 0 || at(nx, ny, dy[i] > 0 ? 2 : 6) > 0))
+		return 1;
+
+	int16_t t = at(nx, ny, i);
+	return t > 0 ? t + 1 : t - 1;
+}
+
+//Recomputes the east and west entries of row y, adding the units whose entries changed to changed
+void JumpTable::sweepRow(int y, std::vector<int> &changed)
+{
+	for (int x = w - 1; x >= 0; x--)
+	{
+		int16_t e = entry(x, y, 0);
+		if (e != at(x, y, 0))
+		{
+			at(x, y, 0) = e;
+			changed.push_back(map.unitId(x, y));
+		}
+	}
+	for (int x = 0; x < w; x++)
+	{
+		int16_t e = entry(x, y, 4);
+		if (e != at(x, y, 4))
+		{
+			at(x, y, 4) = e;
+			changed.push_back(map.unitId(x, y));
+		}
+	}
+}
+
+//Recomputes the south and north entries of column x
+void JumpTable::sweepColumn(int x, std::vector<int> &changed)
+{
+	for (int y = h - 1; y >= 0; y--)
+	{
+		int16_t e = entry(x, y, 2);
+		if (e != at(x, y, 2))
+		{
+			at(x, y, 2) = e;
+			changed.push_back(map.unitId(x, y));
+		}
+	}
+	for (int y = 0; y < h; y++)
+	{
+		int16_t e = entry(x, y, 6);
+		if (e != at(x, y, 6))
+		{
+			at(x, y, 6) = e;
+			changed.push_back(map.unitId(x, y));
+		}
+	}
+}
+
+//Something (x, y) looks at changed, so the diagonal entries that step onto it are redone, and the ones
+//before those while they keep changing
+void JumpTable::repairDiagonals(int x, int y)
+{
+	for (int i = 1; i < dir; i += 2)
+	{
+		for (int ux = x - dx[i], uy = y - dy[i]; ux >= 0 && ux < w && uy >= 0 && uy < h; ux -= dx[i], uy -= dy[i])
+		{
+			int16_t e = entry(ux, uy, i);
+			if (e == at(ux, uy, i))
+				break;
+			at(ux, uy, i) = e;
+		}
+	}
+}
+
+//Straight entries look at the units beside the line as well as on it, so an edit reaches the rows and columns next to it.
+//Diagonal entries look at the 3 x 3 block around the next unit and its straight entries.
+void JumpTable::unitChanged(int x, int y)
+{
+	if (!usable())
+		return;
+
+	std::vector<int> changed;
+	for (int y2 = std::max(y - 1, 0); y2 <= std::min(y + 1, h - 1); y2++)
+		sweepRow(y2, changed);
+	for (int x2 = std::max(x - 1, 0); x2 <= std::min(x + 1, w - 1); x2++)
+		sweepColumn(x2, changed);
+
+	for (int y2 = std::max(y - 1, 0); y2 <= std::min(y + 1, h - 1); y2++)
+		for (int x2 = std::max(x - 1, 0); x2 <= std::min(x + 1, w - 1); x2++)
+			repairDiagonals(x2, y2);
+
+	for (int u : changed)
+	{
+		Position p = map.position(u);
+		repairDiagonals(p.x, p.y);
+	}
+}
+
+//The table ignores the goal, so it's checked here: a straight jump reaches it when it lies on the line
+//within the entry's reach. A diagonal jump stops on the goal, or on the unit where it reaches the goal's row
+//or column if the straight jump from there gets to the goal.
+int JumpTable::jump(int x, int y, int ddx, int ddy, int goal) const
+{
+	int i = directionOf[(ddy + 1) * 3 + ddx + 1];
+	int d = at(x, y, i);
+	int reach = std::abs(d);
+
+	Position g = map.position(goal);
+	int gx = (g.x - x) * ddx; //Steps to the goal along each axis, going this way
+	int gy = (g.y - y) * ddy;
+
+	if (ddy == 0)
+	{
+		if (g.y == y && gx > 0 && gx <= reach)
+			return goal;
+		return d > 0 ? map.unitId(x + ddx * d, y) : -1;
+	}
+	if (ddx == 0)
+	{
+		if (g.x == x && gy > 0 && gy <= reach)
+			return goal;
+		return d > 0 ? map.unitId(x, y + ddy * d) : -1;
+	}
+
+	int best = d > 0 ? d : INT16_MAX + 1;
+
+	if (gx > 0 && gy > 0)
+	{
+		int s = std::min(gx, gy);
+		if (s <= reach && s < best)
+		{
+			int sx = x + ddx * s, sy = y + ddy * s;
+
+			//A straight entry that is a jump point makes (sx, sy) one as well, so best is already there or closer
+			if (gx == gy ||
+				(gx > gy && gx - gy <= -at(sx, sy, ddx > 0 ? 0 : 4)) ||
+				(gy > gx && gy - gx <= -at(sx, sy, ddy > 0 ? 2 : 6)))
+				best = s;
+		}
+	}
+
+	if (best > INT16_MAX)
+		return -1;
+	return map.unitId(x + ddx * best, y + ddy * best);
+}
@@ -0,0 +1,75 @@
+/*
+File Name : JumpTable.h
+Copyright  2018
+Original authors : Sanketh Bhat
+Written under the supervision of David I.Schwartz, Ph.D., and
+supported by a professional development seed grant from the B.Thomas
+Golisano College of Computing & Information Sciences
+(https ://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software : you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+JPS+ jump distances. For every unit and each of the 8 directions the table holds how far a jump from it
+goes, so Jump Point Search finds each successor with one lookup instead of stepping along the line.
+*/
+
+//Harabor, D. and Grastien, A. "Improving Jump Point Search", ICAPS 2014
+#ifndef JUMP_TABLE_H
+#define JUMP_TABLE_H
+
+#include "graph.h"
+
+//Table for SearchMode::jumpPointPlus. Build it once with build(); after that it registers every edit
+//and repairs itself right away, so it never needs a full rebuild and queries never wait for one.
+//An edit recomputes the three rows and three columns through it, then walks back along each diagonal
+//from every unit whose entries changed, stopping as soon as an entry comes out the same.
+//
+//Jumps from the table find exactly the jump points graph::jump finds, so searches give the same paths.
+class JumpTable : public MapListener {
+
+	graph &map;
+	int w = 0, h = 0;
+
+	//dist[unit * dir + i] for direction i of the dx/dy tables. n > 0: the n-th unit on is a jump point.
+	//n <= 0: no jump point, and -n units can be stepped over before an obstacle or the map edge.
+	//Ignores the goal, jump() adds it per query. Stored unit by unit so a whole expansion reads 16 bytes.
+	std::vector<int16_t> dist;
+
+	int16_t &at(int x, int y, int i) { return dist[((size_t)y * w + x) * dir + i]; }
+	int16_t at(int x, int y, int i) const { return dist[((size_t)y * w + x) * dir + i]; }
+
+	bool forced(int x, int y, int i) const;
+	int16_t entry(int x, int y, int i) const;
+	void sweepRow(int y, std::vector<int> &changed);
+	void sweepColumn(int x, std::vector<int> &changed);
+	void repairDiagonals(int x, int y);
+
+public:
+	JumpTable(graph &map);
+	~JumpTable();
+	JumpTable(const JumpTable &) = delete;
+	JumpTable &operator=(const JumpTable &) = delete;
+
+	//Fills the whole table, O(units). Returns false for maps over 32767 units across, which int16_t can't span.
+	bool build();
+	bool usable() const { return !dist.empty(); }
+
+	void unitChanged(int x, int y) override;
+
+	//Same result as graph::jump: the jump point or goal found going from (x, y) in direction (ddx, ddy), -1 for none
+	int jump(int x, int y, int ddx, int ddy, int goal) const;
+};
+
+#endif //JUMP_TABLE_H
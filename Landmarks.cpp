@@ -0,0 +1,316 @@
+/*
+File Name : Landmarks.cpp
+Copyright  2018
+Original authors : Sanketh Bhat
+Written under the supervision of David I.Schwartz, Ph.D., and
+supported by a professional development seed grant from the B.Thomas
+Golisano College of Computing & Information Sciences
+(https ://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software : you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.If not, see <http://www.gnu.org/licenses/>.
+
+
+Description:
+Landmark (ALT) heuristic. Exact distances from a few landmark units to every unit are worked out ahead
+of time, and the triangle inequality turns them into a lower bound on the cost between any two units.
+*/
+
+#include "Landmarks.h"
+
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const float INF = std::numeric_limits<float>::infinity();
+
+//Start of a landmark file. The landmark ids follow, then the distance table exactly as it is kept in memory.
+struct LandmarkFileHeader {
+	char magic[4];
+	uint32_t version;
+	int32_t width;
+	int32_t height;
+	int32_t count;
+	int32_t neighborhood;
+	uint64_t mapHash; //Of the map the table was saved with, see mapHash
+};
+
+static const char LANDMARK_MAGIC[4] = { 'A', 'L', 'T', 'T' };
+static const uint32_t LANDMARK_VERSION = 2;
+
+//FNV-1a over the weight of every unit, 0 for blocked ones. A table only fits the map it was measured on,
+//and a map of the same size with other obstacles or weights would give estimates that are too high.
+static uint64_t mapHash(const graph &map)
+{
+	uint64_t hash = 14695981039346656037ull;
+	for (int y = 0; y < map.height(); y++)
+		for (int x = 0; x < map.width(); x++)
+		{
+			hash ^= map.passable(x, y) ? map.getWeight(x, y) : 0;
+			hash *= 1099511628211ull;
+		}
+	return hash;
+}
+
+Landmarks::Landmarks(graph &map) : map(map)
+{
+	map.addListener(this);
+}
+
+Landmarks::~Landmarks()
+{
+	unmap();
+	map.removeListener(this);
+}
+
+void Landmarks::unitChanged(int x, int y)
+{
+	if (map.passable(x, y))
+		stale = true;
+}
+
+void Landmarks::build(int count)
+{
+	unmap();
+	table.clear();
+	ids.clear();
+	k = 0;
+	n = map.width() * map.height();
+	moves = map.neighborhood;
+	stale = false;
+
+	//Any open unit near the middle of the map starts the selection. The first landmark is the unit
+	//farthest from it, and every later one the unit farthest from all landmarks picked so far.
+	int seed = -1;
+	for (int i = 0; i < n && seed == -1; i++)
+	{
+		int u = (n / 2 + map.width() / 2 + i) % n;
+		Position p = map.position(u);
+		if (map.passable(p.x, p.y))
+			seed = u;
+	}
+	if (seed == -1)
+		return;
+
+	std::vector<std::vector<float>> rows;
+	std::vector<float> d;
+	std::vector<float> nearest(n, INF);
+
+	if (moves == Neighborhood::four)
+		distances<FourNeighbors>(seed, nearest);
+	else
+		distances<EightNeighbors>(seed, nearest);
+
+	while ((int)ids.size() < count)
+	{
+		//Units no landmark reaches are in another part of the map, they are left out rather than spending landmarks on them
+		int next = -1;
+		for (int u = 0; u < n; u++)
+			if (nearest[u] != INF && (next == -1 || nearest[u] > nearest[next]))
+				next = u;
+
+		if (next == -1 || (!ids.empty() && nearest[next] == 0))
+			break;
+
+		if (moves == Neighborhood::four)
+			distances<FourNeighbors>(next, d);
+		else
+			distances<EightNeighbors>(next, d);
+
+		if (ids.empty())
+			std::fill(nearest.begin(), nearest.end(), INF);
+		for (int u = 0; u < n; u++)
+			nearest[u] = std::min(nearest[u], d[u]);
+
+		ids.push_back(next);
+		rows.push_back(d);
+	}
+
+	k = (int)ids.size();
+	table.resize((size_t)n * k);
+	for (int u = 0; u < n; u++)
+		for (int i = 0; i < k; i++)
+			table[(size_t)u * k + i] = rows[i][u];
+	dist = table.data();
+}
+
+//Dijkstra from one unit over the whole map. Costs are whole numbers, so the bucket queue orders them exactly.
+template<class N>
+void Landmarks::distances(int from, std::vector<float> &out) const
+{
+	out.assign(n, INF);
+
+	BucketQueue open(n);
+	out[from] = 0;
+	open.push(from, 0);
+
+	while (!open.empty())
+	{
+		int u = open.top().id;
+		open.pop();
+
+		Position p = map.position(u);
+		for (int i = 0; i < N::count; i++)
+		{
+			int x = p.x + N::dx(i);
+			int y = p.y + N::dy(i);
+			if (!map.passable(x, y))
+				continue;
+
+			int v = map.unitId(x, y);
+			float nd = out[u] + map.moveCost(u, v, N::cost(i));
+			if (nd < out[v])
+			{
+				if (open.contains(v))
+					open.decreaseKey(v, nd);
+				else
+					open.push(v, nd);
+				out[v] = nd;
+			}
+		}
+	}
+}
+
+bool Landmarks::save(const char *fileName) const
+{
+	//A stale table may overestimate on the map as it is now, and a load would take it as valid
+	if (stale)
+		return false;
+
+	FILE *f = fopen(fileName, "wb");
+	if (!f)
+		return false;
+
+	LandmarkFileHeader header;
+	memcpy(header.magic, LANDMARK_MAGIC, sizeof(header.magic));
+	header.version = LANDMARK_VERSION;
+	header.width = map.width();
+	header.height = map.height();
+	header.count = k;
+	header.neighborhood = (int32_t)moves;
+	header.mapHash = mapHash(map);
+
+	bool ok = fwrite(&header, sizeof(header), 1, f) == 1
+		&& fwrite(ids.data(), sizeof(int), k, f) == (size_t)k
+		&& fwrite(dist, sizeof(float), (size_t)n * k, f) == (size_t)n * k;
+
+	return fclose(f) == 0 && ok;
+}
+
+bool Landmarks::load(const char *fileName)
+{
+	unmap();
+	table.clear();
+	ids.clear();
+	k = 0;
+	n = 0;
+	stale = false;
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+	HANDLE mapping = NULL;
+	if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+		mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (!mapping)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	fileHandle = file;
+	mappingHandle = mapping;
+	mappedSize = (size_t)size.QuadPart;
+	mapped = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+#else
+	int file = open(fileName, O_RDONLY);
+	if (file == -1)
+		return false;
+
+	struct stat info;
+	if (fstat(file, &info) == 0 && info.st_size > 0)
+	{
+		mappedSize = (size_t)info.st_size;
+		mapped = mmap(nullptr, mappedSize, PROT_READ, MAP_SHARED, file, 0);
+		if (mapped == MAP_FAILED)
+			mapped = nullptr;
+	}
+	close(file); //The mapping keeps the file open
+#endif
+
+	if (!mapped)
+	{
+		unmap();
+		return false;
+	}
+
+	//Check the file really is a table for this map before trusting any of it
+	const char *bytes = (const char *)mapped;
+	LandmarkFileHeader header;
+	size_t units = (size_t)map.width() * map.height();
+
+	if (mappedSize < sizeof(header))
+	{
+		unmap();
+		return false;
+	}
+	memcpy(&header, bytes, sizeof(header));
+
+	if (memcmp(header.magic, LANDMARK_MAGIC, sizeof(header.magic)) != 0 || header.version != LANDMARK_VERSION
+		|| header.width != map.width() || header.height != map.height() || header.count < 0 || header.mapHash != mapHash(map)
+		|| mappedSize != sizeof(header) + header.count * sizeof(int) + units * header.count * sizeof(float))
+	{
+		unmap();
+		return false;
+	}
+
+	n = (int)units;
+	k = header.count;
+	moves = (Neighborhood)header.neighborhood;
+	ids.assign((const int *)(bytes + sizeof(header)), (const int *)(bytes + sizeof(header)) + k);
+	dist = (const float *)(bytes + sizeof(header) + k * sizeof(int));
+
+	return true;
+}
+
+void Landmarks::unmap()
+{
+#ifdef _WIN32
+	if (mapped)
+		UnmapViewOfFile(mapped);
+	if (mappingHandle)
+		CloseHandle(mappingHandle);
+	if (fileHandle)
+		CloseHandle(fileHandle);
+	fileHandle = mappingHandle = nullptr;
+#else
+	if (mapped)
+		munmap(mapped, mappedSize);
+#endif
+	mapped = nullptr;
+	mappedSize = 0;
+	dist = nullptr;
+}
@@ -0,0 +1,107 @@
+/*
+File Name : Landmarks.h
+Copyright  2018
+Original authors : Sanketh Bhat
+Written under the supervision of David I.Schwartz, Ph.D., and
+supported by a professional development seed grant from the B.Thomas
+Golisano College of Computing & Information Sciences
+(https ://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software : you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.If not, see <http://www.gnu.org/licenses/>.
+
+
+Description:
+Landmark (ALT) heuristic. Exact distances from a few landmark units to every unit are worked out ahead
+of time, and the triangle inequality turns them into a lower bound on the cost between any two units.
+*/
+
+//Goldberg, A. and Harrelson, C. "Computing the Shortest Path: A* Search Meets Graph Theory", SODA 2005
+#ifndef LANDMARKS_H
+#define LANDMARKS_H
+
+#include "graph.h"
+
+//Distance table for Heuristic::landmarks. Build it once with build(), or save() it and load() it at startup:
+//load maps the file read-only instead of reading it, so every process that loads it shares the same pages.
+//
+//Blocking units only makes real costs go up, so the table stays a valid lower bound after setObstacle.
+//Clearing a unit or changing the weight of an open one can make routes shorter than the table says, so that
+//marks it stale and graph falls back to the octile estimate until the table is rebuilt.
+class Landmarks : public MapListener {
+
+	graph &map;
+	int n = 0; //Units in the table
+	int k = 0; //Landmarks in the table
+	Neighborhood moves = Neighborhood::eight; //Neighborhood the distances were measured with
+	bool stale = false;
+
+	std::vector<int> ids; //Unit id of each landmark
+
+	//dist[unit * k + landmark] is the cost from the landmark to the unit, infinity when it can't be reached.
+	//Stored unit by unit so one estimate reads one short run of memory. Points into table or into the mapped file.
+	const float *dist = nullptr;
+	std::vector<float> table;
+
+	void *mapped = nullptr; //Start of the mapped file, null when the table is in memory
+	size_t mappedSize = 0;
+#ifdef _WIN32
+	void *fileHandle = nullptr;
+	void *mappingHandle = nullptr;
+#endif
+
+	template<class N>
+	void distances(int from, std::vector<float> &out) const;
+	void unmap();
+
+public:
+	Landmarks(graph &map);
+	~Landmarks();
+	Landmarks(const Landmarks &) = delete;
+	Landmarks &operator=(const Landmarks &) = delete;
+
+	//Picks count landmarks, each as far as possible from the ones before, and measures the distances
+	//from each with Dijkstra using the graph's current neighborhood. O(count * units * log units)
+	void build(int count);
+
+	bool save(const char *fileName) const; //false without writing anything when the table is stale
+	bool load(const char *fileName); //false, leaving the table empty, when the file is missing or was saved with another map
+
+	void unitChanged(int x, int y) override;
+
+	int count() const { return k; }
+	const std::vector<int> &landmarks() const { return ids; }
+
+	//Whether the table gives a lower bound for searches with neighbors n. Distances measured with 8 neighbors
+	//are never more than the 4 neighbor ones, so an 8 neighbor table works for both.
+	bool usable(Neighborhood n) const { return k > 0 && !stale && (moves == Neighborhood::eight || moves == n); }
+
+	//Largest |d(L, goal) - d(L, id)| over the landmarks L. Landmarks that can't reach both units are skipped.
+	float estimate(int id, int goal) const
+	{
+		const float *a = dist + (size_t)id * k;
+		const float *b = dist + (size_t)goal * k;
+		float best = 0;
+
+		for (int i = 0; i < k; i++)
+		{
+			float d = std::abs(b[i] - a[i]);
+			if (d > best && d != std::numeric_limits<float>::infinity()) //NaN (both unreachable) fails d > best too
+				best = d;
+		}
+
+		return best;
+	}
+};
+
+#endif //LANDMARKS_H
@@ -0,0 +1,139 @@
+/*
+File Name : MovingAI.cpp
+Copyright  2018
+Original authors : Sanketh Bhat
+Written under the supervision of David I.Schwartz, Ph.D., and
+supported by a professional development seed grant from the B.Thomas
+Golisano College of Computing & Information Sciences
+(https ://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software : you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.If not, see <http://www.gnu.org/licenses/>.
+
+
+Description:
+Reads maps and scenarios in the MovingAI grid benchmark format (https://movingai.com/benchmarks/formats.html)
+*/
+
+#include "MovingAI.h"
+
+#include <fstream>
+#include <sstream>
+
+bool movingAIPassable(char terrain)
+{
+	return terrain == '.' || terrain == 'G' || terrain == 'S';
+}
+
+std::unique_ptr<graph> loadMovingAIMap(const char *fileName)
+{
+	std::ifstream in(fileName);
+	if (!in)
+		return nullptr;
+	return loadMovingAIMap(in);
+}
+
+std::unique_ptr<graph> loadMovingAIMap(std::istream &in)
+{
+	std::string word, type;
+	int w = -1, h = -1;
+
+	//Header: "type octile", "height h", "width w" in any order, then "map" on its own line
+	while (in >> word && word != "map")
+	{
+		if (word == "type")
+			in >> type;
+		else if (word == "height")
+			in >> h;
+		else if (word == "width")
+			in >> w;
+		else
+			return nullptr;
+	}
+
+	if (word != "map" || w <= 0 || h <= 0)
+		return nullptr;
+
+	std::unique_ptr<graph> map(new graph(w, h));
+	std::string row;
+	std::getline(in, row); //Rest of the "map" line
+
+	for (int y = 0; y < h; y++)
+	{
+		if (!std::getline(in, row))
+			return nullptr;
+		if (!row.empty() && row.back() == '\r')
+			row.pop_back();
+		if ((int)row.size() < w)
+			return nullptr;
+
+		for (int x = 0; x < w; x++)
+			if (!movingAIPassable(row[x]))
+				map->setObstacle(x, y);
+	}
+
+	return map;
+}
+
+bool loadMovingAIScenario(const char *fileName, MovingAIScenario &scenario)
+{
+	std::ifstream in(fileName);
+	if (!in)
+		return false;
+	return loadMovingAIScenario(in, scenario);
+}
+
+//Each query line is: bucket, map, map width, map height, start x, start y, goal x, goal y, optimal length
+bool loadMovingAIScenario(std::istream &in, MovingAIScenario &scenario)
+{
+	std::string line, map;
+
+	scenario.queries.clear();
+
+	//"version 1" or "version 1.0". Very old files have no version line and start with the queries.
+	if (!std::getline(in, line))
+		return false;
+	if (line.compare(0, 7, "version") != 0)
+		in.seekg(0);
+
+	while (std::getline(in, line))
+	{
+		if (!line.empty() && line.back() == '\r')
+			line.pop_back();
+		if (line.empty())
+			continue;
+
+		std::istringstream fields(line);
+		MovingAIQuery q;
+		int w, h;
+
+		if (!(fields >> q.bucket >> map >> w >> h >> q.from.x >> q.from.y >> q.to.x >> q.to.y >> q.optimal))
+			return false;
+
+		if (scenario.queries.empty())
+		{
+			scenario.map = map;
+			scenario.mapWidth = w;
+			scenario.mapHeight = h;
+		}
+		else if (map != scenario.map)
+			return false;
+
+		if (q.from.x < 0 || q.from.x >= w || q.from.y < 0 || q.from.y >= h || q.to.x < 0 || q.to.x >= w || q.to.y < 0 || q.to.y >= h)
+			return false;
+
+		scenario.queries.push_back(q);
+	}
+
+	return true;
+}
@@ -0,0 +1,63 @@
+/*
+File Name : MovingAI.h
+Copyright  2018
+Original authors : Sanketh Bhat
+Written under the supervision of David I.Schwartz, Ph.D., and
+supported by a professional development seed grant from the B.Thomas
+Golisano College of Computing & Information Sciences
+(https ://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software : you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.If not, see <http://www.gnu.org/licenses/>.
+
+
+Description:
+Reads maps and scenarios in the MovingAI grid benchmark format (https://movingai.com/benchmarks/formats.html)
+*/
+
+#ifndef MOVING_AI_H
+#define MOVING_AI_H
+
+#include <memory>
+
+#include "graph.h"
+
+//One line of a .scen file
+struct MovingAIQuery {
+	int bucket;
+	Position from;
+	Position to;
+	double optimal; //Optimal length in the benchmark's own units: 1 per straight move, sqrt(2) per diagonal, no corner cutting
+};
+
+struct MovingAIScenario {
+	std::string map; //Map file named by the queries, as written in the file
+	int mapWidth = 0;
+	int mapHeight = 0;
+	std::vector<MovingAIQuery> queries;
+};
+
+//Whether a .map terrain character can be walked on. '.', 'G' and 'S' (swamp) are ground, everything
+//else ('@' and 'O' out of bounds, 'T' trees, 'W' water) is treated as an obstacle.
+bool movingAIPassable(char terrain);
+
+//Reads a .map file into a new graph. The rows are read one at a time into one buffer and written straight
+//to the graph, so a map takes one byte per unit while loading too. Returns null if the file can't be read.
+std::unique_ptr<graph> loadMovingAIMap(const char *fileName);
+std::unique_ptr<graph> loadMovingAIMap(std::istream &in);
+
+//Reads a .scen file. Every query has to name the same map. Returns false if the file can't be read.
+bool loadMovingAIScenario(const char *fileName, MovingAIScenario &scenario);
+bool loadMovingAIScenario(std::istream &in, MovingAIScenario &scenario);
+
+#endif //MOVING_AI_H
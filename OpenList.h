@@ -0,0 +1,353 @@
+/*
+File Name : OpenList.h
+Copyright  2018
+Original authors : Sanketh Bhat
+Written under the supervision of David I.Schwartz, Ph.D., and
+supported by a professional development seed grant from the B.Thomas
+Golisano College of Computing & Information Sciences
+(https ://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software : you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Open list containers used by the A* search in graph.cpp
+*/
+
+#ifndef OPEN_LIST_H
+#define OPEN_LIST_H
+
+#include <queue>
+#include <vector>
+#include <algorithm>
+
+//Selects which open list graph::aStarPF uses
+enum class OpenListMode {
+	rebuild,		//priority_queue, decrease-key rebuilds the whole queue (the original behavior)
+	indexedHeap,	//binary heap with a unit->slot map, decrease-key is O(log n)
+	bucket			//one bucket per whole f value, push/pop/decrease-key are amortized O(1)
+};
+
+//A unit id and its priority (f) as stored in an open list
+struct OpenEntry {
+	float f;
+	int id;
+};
+
+//Inverted so std::priority_queue pops the lowest f first
+static bool operator<(const OpenEntry &A, const OpenEntry &B)
+{
+	return A.f > B.f;
+}
+
+//The original open list: a priority queue that has to be rebuilt to change a priority
+class RebuildQueue {
+
+	std::priority_queue<OpenEntry> entries;
+	std::priority_queue<OpenEntry> temp;
+
+public:
+	bool empty() const { return entries.empty(); }
+	int size() const { return (int)entries.size(); }
+	const OpenEntry &top() const { return entries.top(); }
+
+	void push(int id, float f) { entries.push({ f, id }); }
+	void pop() { entries.pop(); }
+
+	void clear()
+	{
+		while (!entries.empty())
+			entries.pop();
+	}
+
+	//Moves every entry to a temporary queue and back, replacing the one with a matching id. O(n log n)
+	void decreaseKey(int id, float f)
+	{
+		entries.swap(temp);
+
+		while (!temp.empty())
+		{
+			if (temp.top().id == id)
+				entries.push({ f, id });
+			else
+				entries.push(temp.top());
+
+			temp.pop();
+		}
+	}
+};
+
+//Binary min-heap that also remembers where each unit id sits, so a priority can be changed in place.
+//Key only needs operator<.
+template<class Key>
+class KeyedHeap {
+
+public:
+	struct Entry {
+		Key key;
+		int id;
+	};
+
+private:
+	std::vector<Entry> heap;
+	std::vector<int> slot; //slot[id] = index of the id in heap, -1 when it is not in the list
+
+	void place(int i, const Entry &e)
+	{
+		heap[i] = e;
+		slot[e.id] = i;
+	}
+
+	//Moves the entry at i towards the root until its parent has a lower key
+	void siftUp(int i)
+	{
+		Entry e = heap[i];
+		while (i > 0)
+		{
+			int parent = (i - 1) / 2;
+			if (!(e.key < heap[parent].key))
+				break;
+			place(i, heap[parent]);
+			i = parent;
+		}
+		place(i, e);
+	}
+
+	//Moves the entry at i towards the leaves until both children have a higher key
+	void siftDown(int i)
+	{
+		Entry e = heap[i];
+		int n = (int)heap.size();
+		while (true)
+		{
+			int child = 2 * i + 1;
+			if (child >= n)
+				break;
+			if (child + 1 < n && heap[child + 1].key < heap[child].key)
+				child++;
+			if (!(heap[child].key < e.key))
+				break;
+			place(i, heap[child]);
+			i = child;
+		}
+		place(i, e);
+	}
+
+public:
+	KeyedHeap(int unitCount = 0) : slot(unitCount, -1) {}
+
+	//Makes room for ids in [0, unitCount). Clears the list.
+	void resize(int unitCount)
+	{
+		heap.clear();
+		slot.assign(unitCount, -1);
+	}
+
+	bool empty() const { return heap.empty(); }
+	int size() const { return (int)heap.size(); }
+	bool contains(int id) const { return slot[id] != -1; }
+	const Entry &top() const { return heap.front(); }
+
+	void push(int id, Key key)
+	{
+		heap.push_back({ key, id });
+		siftUp((int)heap.size() - 1);
+	}
+
+	void pop()
+	{
+		remove(heap.front().id);
+	}
+
+	//Takes any id out of the list. O(log n)
+	void remove(int id)
+	{
+		int i = slot[id];
+		slot[id] = -1;
+
+		Entry last = heap.back();
+		heap.pop_back();
+		if (i < (int)heap.size())
+		{
+			place(i, last);
+			update(last.id, last.key);
+		}
+	}
+
+	//Only resets the slots that are actually in use
+	void clear()
+	{
+		for (const Entry &e : heap)
+			slot[e.id] = -1;
+		heap.clear();
+	}
+
+	//Lowers the priority of an id already in the list. O(log n)
+	void decreaseKey(int id, Key key)
+	{
+		int i = slot[id];
+		heap[i].key = key;
+		siftUp(i);
+	}
+
+	//Changes the priority of an id already in the list in either direction. O(log n)
+	void update(int id, Key key)
+	{
+		int i = slot[id];
+		heap[i].key = key;
+		siftUp(i);
+		siftDown(slot[id]);
+	}
+};
+
+//The open list used by graph, keyed by f
+typedef KeyedHeap<float> IndexedHeap;
+
+//Bucket queue for whole number priorities. Move costs are 10 and 14, so with the octile, Manhattan
+//or zero heuristic every f is a whole number and the queue pops in exactly the same order of f as a heap.
+//Fractional priorities (Euclidean) are rounded down, so entries less than 1 apart may come out in either order.
+//
+//The buckets form a ring indexed by f modulo its size. Only the span between the lowest and highest f
+//in the list needs a bucket each, which on a grid is a few dozen values however large the map is.
+//The ring doubles when the span outgrows it. f never has to rise monotonically: a lower push just moves low back.
+class BucketQueue {
+
+	std::vector<std::vector<OpenEntry>> buckets;
+	std::vector<int> slot; //slot[id] = index of the id in its bucket, -1 when it is not in the list
+	std::vector<int> keys; //keys[id] = bucket key of the id while it is in the list
+	int mask = 0; //buckets.size() - 1, the size is a power of two
+	int low = 0; //f of the lowest non-empty bucket while the list isn't empty
+	int high = 0; //no entry has a higher f than this
+	int count = 0;
+
+	static int keyOf(float f) { return (int)f; }
+
+	std::vector<OpenEntry> &bucketOf(int key) { return buckets[key & mask]; }
+
+	//Makes the ring big enough for keys from lo to hi and moves every entry to its new bucket
+	void grow(int lo, int hi)
+	{
+		int n = (int)buckets.size();
+		while (n <= hi - lo)
+			n *= 2;
+
+		std::vector<std::vector<OpenEntry>> old(n);
+		old.swap(buckets);
+		mask = n - 1;
+
+		for (std::vector<OpenEntry> &b : old)
+			for (const OpenEntry &e : b)
+			{
+				std::vector<OpenEntry> &to = bucketOf(keyOf(e.f));
+				slot[e.id] = (int)to.size();
+				to.push_back(e);
+			}
+	}
+
+	//Moves low up to the next non-empty bucket
+	void advance()
+	{
+		if (count == 0)
+			return;
+		while (bucketOf(low).empty())
+			low++;
+	}
+
+public:
+	BucketQueue(int unitCount = 0) : buckets(64), slot(unitCount, -1), keys(unitCount), mask(63) {}
+
+	//Makes room for ids in [0, unitCount). Clears the list.
+	void resize(int unitCount)
+	{
+		for (std::vector<OpenEntry> &b : buckets)
+			b.clear();
+		slot.assign(unitCount, -1);
+		keys.resize(unitCount);
+		count = 0;
+	}
+
+	bool empty() const { return count == 0; }
+	int size() const { return count; }
+	bool contains(int id) const { return slot[id] != -1; }
+
+	//Newest entry of the lowest bucket, so ties go depth first
+	const OpenEntry &top() const { return buckets[low & mask].back(); }
+
+	void push(int id, float f)
+	{
+		int key = keyOf(f);
+
+		if (count == 0)
+			low = high = key;
+		else
+		{
+			int lo = std::min(low, key);
+			int hi = std::max(high, key);
+			if (hi - lo > mask)
+				grow(lo, hi);
+			low = lo;
+			high = hi;
+		}
+
+		std::vector<OpenEntry> &b = bucketOf(key);
+		slot[id] = (int)b.size();
+		keys[id] = key;
+		b.push_back({ f, id });
+		count++;
+	}
+
+	void pop()
+	{
+		remove(top().id);
+	}
+
+	//Takes any id out of the list by swapping it with the last entry of its bucket. O(1)
+	void remove(int id)
+	{
+		std::vector<OpenEntry> &b = bucketOf(keys[id]);
+		int i = slot[id];
+		slot[id] = -1;
+
+		if (i != (int)b.size() - 1)
+		{
+			b[i] = b.back();
+			slot[b[i].id] = i;
+		}
+		b.pop_back();
+
+		count--;
+		advance();
+	}
+
+	//Only clears the buckets that can be in use
+	void clear()
+	{
+		if (count > 0)
+			for (int key = low; key <= high; key++)
+			{
+				for (const OpenEntry &e : bucketOf(key))
+					slot[e.id] = -1;
+				bucketOf(key).clear();
+			}
+		count = 0;
+	}
+
+	//Moves an id already in the list to the bucket of its new priority. Amortized O(1)
+	void decreaseKey(int id, float f)
+	{
+		remove(id);
+		push(id, f);
+	}
+};
+
+#endif //OPEN_LIST_H
@@ -0,0 +1,138 @@
+/*
+File Name : PassGrid.h
+Copyright  2018
+Original authors : Sanketh Bhat
+Written under the supervision of David I.Schwartz, Ph.D., and
+supported by a professional development seed grant from the B.Thomas
+Golisano College of Computing & Information Sciences
+(https ://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software : you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Passability of every unit as one bit, 64 units to a machine word. Whole row segments are tested
+with a few word operations instead of one unit at a time.
+*/
+
+#ifndef PASS_GRID_H
+#define PASS_GRID_H
+
+#include <vector>
+#include <cstdint>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+//Index of the lowest and highest set bit of a word that isn't 0
+static inline int lowestBit(uint64_t v)
+{
+#ifdef _MSC_VER
+	unsigned long i;
+	_BitScanForward64(&i, v);
+	return (int)i;
+#else
+	return __builtin_ctzll(v);
+#endif
+}
+
+static inline int highestBit(uint64_t v)
+{
+#ifdef _MSC_VER
+	unsigned long i;
+	_BitScanReverse64(&i, v);
+	return (int)i;
+#else
+	return 63 - __builtin_clzll(v);
+#endif
+}
+
+//A set bit is a passable unit. Every row has MARGIN blocked units of padding on the left and at least as many
+//on the right, and there is a blocked row above and below the map, so reads that run a little off the map need
+//no bounds checks and see obstacles there. A 10000 x 10000 map takes about 12 MB.
+class PassGrid {
+
+	static const int MARGIN = 128;
+
+	int w = 0, h = 0;
+	int stride = 0; //Words per row
+	std::vector<uint64_t> words;
+
+	const uint64_t *row(int y) const { return &words[(size_t)(y + 1) * stride]; }
+
+public:
+	//Every unit passable
+	void resize(int width, int height)
+	{
+		w = width;
+		h = height;
+		stride = ((MARGIN + w + MARGIN) >> 6) + 1;
+		words.assign((size_t)(h + 2) * stride, 0);
+
+		//MARGIN is a whole number of words, so each row starts on a word of its own
+		for (int y = 0; y < h; y++)
+		{
+			uint64_t *r = &words[(size_t)(y + 1) * stride + (MARGIN >> 6)];
+			for (int i = 0; i < (w >> 6); i++)
+				r[i] = ~(uint64_t)0;
+			if (w & 63)
+				r[w >> 6] = ((uint64_t)1 << (w & 63)) - 1;
+		}
+	}
+
+	//x from -MARGIN to width + MARGIN - 1, y from -1 to height
+	bool get(int x, int y) const
+	{
+		int k = x + MARGIN;
+		return (row(y)[k >> 6] >> (k & 63)) & 1;
+	}
+
+	void set(int x, int y, bool open)
+	{
+		int k = x + MARGIN;
+		uint64_t &word = words[(size_t)(y + 1) * stride + (k >> 6)];
+		uint64_t bit = (uint64_t)1 << (k & 63);
+		word = open ? (word | bit) : (word & ~bit);
+	}
+
+	//Units x to x + 63 of row y, unit x + i in bit i. x from -MARGIN to width, y from -1 to height.
+	uint64_t bits(int x, int y) const
+	{
+		const uint64_t *r = row(y);
+		int k = x + MARGIN;
+		int i = k >> 6, s = k & 63;
+		return s ? (r[i] >> s) | (r[i + 1] << (64 - s)) : r[i];
+	}
+
+	//The 3 x 3 block around a unit on the map, the unit at (x + ox, y + oy) in bit (oy + 1) * 3 + ox + 1
+	unsigned around(int x, int y) const
+	{
+		return (unsigned)(bits(x - 1, y - 1) & 7) | (unsigned)(bits(x - 1, y) & 7) << 3 | (unsigned)(bits(x - 1, y + 1) & 7) << 6;
+	}
+
+	//Whether every unit from x0 to x1 of row y is passable
+	bool rowOpen(int y, int x0, int x1) const
+	{
+		for (int x = x0; x <= x1; x += 64)
+		{
+			int n = x1 - x + 1;
+			uint64_t mask = n >= 64 ? ~(uint64_t)0 : ((uint64_t)1 << n) - 1;
+			if ((bits(x, y) & mask) != mask)
+				return false;
+		}
+		return true;
+	}
+};
+
+#endif //PASS_GRID_H
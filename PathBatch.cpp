@@ -0,0 +1,112 @@
+/*
+File Name : PathBatch.cpp
+Copyright  2018
+Original authors : Sanketh Bhat
+Written under the supervision of David I.Schwartz, Ph.D., and
+supported by a professional development seed grant from the B.Thomas
+Golisano College of Computing & Information Sciences
+(https ://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software : you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Solves batches of path queries on one graph with a pool of worker threads
+*/
+
+#include "PathBatch.h"
+
+PathBatch::PathBatch(const graph &map, int threadCount) : map(map), next(0)
+{
+	if (threadCount <= 0)
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+	contexts.resize(threadCount);
+
+	for (int i = 0; i < threadCount; i++)
+		workers.push_back(std::thread(&PathBatch::work, this, i));
+}
+
+PathBatch::~PathBatch()
+{
+	{
+		std::lock_guard<std::mutex> l(lock);
+		quit = true;
+	}
+	wake.notify_all();
+
+	for (std::thread &t : workers)
+		t.join();
+}
+
+void PathBatch::solve(const PathQuery *q, int n, PathResult *r)
+{
+	if (n <= 0)
+		return;
+
+	std::unique_lock<std::mutex> l(lock);
+	queries = q;
+	results = r;
+	count = n;
+	next = 0;
+	busy = (int)workers.size();
+	batch++;
+	wake.notify_all();
+
+	done.wait(l, [this] { return busy == 0; });
+}
+
+std::vector<PathResult> PathBatch::solve(const std::vector<PathQuery> &q)
+{
+	std::vector<PathResult> r(q.size());
+	solve(q.data(), (int)q.size(), r.data());
+	return r;
+}
+
+//Worker loop: sleeps until a batch arrives, takes queries from it until none are left, then reports back
+void PathBatch::work(int index)
+{
+	unsigned seen = 0;
+
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> l(lock);
+			wake.wait(l, [&] { return quit || batch != seen; });
+			if (quit)
+				return;
+			seen = batch;
+		}
+
+		solveQueries(contexts[index]);
+
+		std::lock_guard<std::mutex> l(lock);
+		if (--busy == 0)
+			done.notify_one();
+	}
+}
+
+//Queries are handed out one at a time, so a few long searches don't leave the other workers idle
+void PathBatch::solveQueries(SearchContext &c)
+{
+	int i;
+	while ((i = next.fetch_add(1)) < count)
+	{
+		PathResult &r = results[i];
+		Position to = queries[i].to;
+
+		r.found = map.findPath(c, queries[i].from, to);
+		r.cost = map.cost(c, to.x, to.y);
+		r.path = c.path;
+	}
+}
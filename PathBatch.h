@@ -0,0 +1,86 @@
+/*
+File Name : PathBatch.h
+Copyright  2018
+Original authors : Sanketh Bhat
+Written under the supervision of David I.Schwartz, Ph.D., and
+supported by a professional development seed grant from the B.Thomas
+Golisano College of Computing & Information Sciences
+(https ://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software : you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Solves batches of path queries on one graph with a pool of worker threads
+*/
+
+#ifndef PATH_BATCH_H
+#define PATH_BATCH_H
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+#include "graph.h"
+
+//One start/end pair of a batch
+struct PathQuery {
+	Position from;
+	Position to;
+};
+
+//The answer to one query
+struct PathResult {
+	bool found = false;
+	float cost = std::numeric_limits<float>::infinity();
+	std::vector<int> path; //Unit ids of the route, start first
+};
+
+//A pool of worker threads that share a read-only graph. Each worker owns a SearchContext, so its
+//search arrays are allocated once and reused for every query it takes.
+//The graph must not be edited while solve() runs, and only one thread may call solve() at a time.
+class PathBatch {
+
+	const graph &map;
+	std::vector<std::thread> workers;
+	std::vector<SearchContext> contexts; //One per worker
+
+	//The batch being solved
+	const PathQuery *queries = nullptr;
+	PathResult *results = nullptr;
+	int count = 0;
+	std::atomic<int> next; //Index of the next query to hand out
+
+	std::mutex lock;
+	std::condition_variable wake; //Workers wait here for a batch
+	std::condition_variable done; //solve() waits here for the workers
+	unsigned batch = 0; //Bumped for every batch so the workers know there is new work
+	int busy = 0; //Workers still on the current batch
+	bool quit = false;
+
+	void work(int index);
+	void solveQueries(SearchContext &c);
+
+public:
+	PathBatch(const graph &map, int threadCount = 0); //0 uses one thread per core
+	~PathBatch();
+
+	int threads() const { return (int)workers.size(); }
+
+	//Solves queries[0..count) and writes each answer to the same index of results
+	void solve(const PathQuery *queries, int count, PathResult *results);
+	std::vector<PathResult> solve(const std::vector<PathQuery> &queries);
+};
+
+#endif //PATH_BATCH_H
@@ -0,0 +1,132 @@
+/*
+File Name : PathCache.cpp
+Copyright  2018
+Original authors : Sanketh Bhat
+Written under the supervision of David I.Schwartz, Ph.D., and
+supported by a professional development seed grant from the B.Thomas
+Golisano College of Computing & Information Sciences
+(https ://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software : you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.If not, see <http://www.gnu.org/licenses/>.
+
+
+Description:
+Cache of recent path queries in front of graph::findPath, with least recently used eviction
+*/
+
+#include "PathCache.h"
+
+PathCache::PathCache(graph &map, size_t maxEntries, size_t maxUnits) : map(map), maxEntries(maxEntries), maxUnits(maxUnits)
+{
+	map.addListener(this);
+}
+
+PathCache::~PathCache()
+{
+	map.removeListener(this);
+}
+
+void PathCache::unitChanged(int x, int y)
+{
+	if (map.passable(x, y))
+	{
+		version++;
+		return;
+	}
+
+	int id = map.unitId(x, y);
+	for (auto e = entries.begin(); e != entries.end();)
+	{
+		auto next = std::next(e);
+
+		if (e->found && e->version == version && x >= e->x0 && x <= e->x1 && y >= e->y0 && y <= e->y1
+			&& std::find(e->path.begin(), e->path.end(), id) != e->path.end())
+			erase(e);
+
+		e = next;
+	}
+}
+
+bool PathCache::findPath(Position from, Position to)
+{
+	uint64_t key = (uint64_t)map.unitId(from.x, from.y) << 32 | (uint32_t)map.unitId(to.x, to.y);
+
+	auto i = index.find(key);
+	if (i != index.end())
+	{
+		if (i->second->version == version)
+		{
+			entries.splice(entries.begin(), entries, i->second);
+			hits++;
+
+			const Entry &e = entries.front();
+			path = e.path;
+			pathCost = e.cost;
+			return e.found;
+		}
+
+		erase(i->second);
+	}
+
+	misses++;
+
+	Entry e;
+	e.key = key;
+	e.version = version;
+	e.found = map.findPath(context, from, to);
+	e.cost = map.cost(context, to.x, to.y);
+	e.path = context.path;
+	e.x0 = e.x1 = from.x;
+	e.y0 = e.y1 = from.y;
+	for (int u : e.path)
+	{
+		Position p = map.position(u);
+		e.x0 = std::min(e.x0, p.x);
+		e.x1 = std::max(e.x1, p.x);
+		e.y0 = std::min(e.y0, p.y);
+		e.y1 = std::max(e.y1, p.y);
+	}
+
+	path = e.path;
+	pathCost = e.cost;
+	bool found = e.found;
+
+	units += e.path.size();
+	entries.push_front(std::move(e));
+	index[key] = entries.begin();
+	evict();
+
+	return found;
+}
+
+void PathCache::erase(std::list<Entry>::iterator e)
+{
+	units -= e->path.size();
+	index.erase(e->key);
+	entries.erase(e);
+}
+
+//Drops least recently used entries until both limits hold
+void PathCache::evict()
+{
+	while (!entries.empty() && (entries.size() > maxEntries || units > maxUnits))
+		erase(std::prev(entries.end()));
+}
+
+void PathCache::clear()
+{
+	entries.clear();
+	index.clear();
+	units = 0;
+}
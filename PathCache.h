@@ -0,0 +1,88 @@
+/*
+File Name : PathCache.h
+Copyright  2018
+Original authors : Sanketh Bhat
+Written under the supervision of David I.Schwartz, Ph.D., and
+supported by a professional development seed grant from the B.Thomas
+Golisano College of Computing & Information Sciences
+(https ://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software : you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.If not, see <http://www.gnu.org/licenses/>.
+
+
+Description:
+Cache of recent path queries in front of graph::findPath, with least recently used eviction
+*/
+
+#ifndef PATH_CACHE_H
+#define PATH_CACHE_H
+
+#include <list>
+#include <unordered_map>
+
+#include "graph.h"
+
+//Remembers the answers to recent queries, keyed by start, end and map version. It registers itself with
+//the graph, and edits only remove answers that may have become wrong:
+//blocking a unit drops just the cached paths that cross it, since every other path is still valid and no
+//route can get cheaper. Clearing a unit or changing the weight of an open one can make any route cheaper or
+//a missing one possible, so it bumps the version, which makes every older entry a miss. Stale entries are dropped when they are next looked up or evicted.
+//Search settings aren't part of the key, call clear() after changing them.
+class PathCache : public MapListener {
+
+	struct Entry {
+		uint64_t key; //start id in the high 32 bits, end id in the low
+		uint32_t version;
+		bool found;
+		float cost;
+		int x0, y0, x1, y1; //Bounds of the path, to skip most paths quickly on an edit
+		std::vector<int> path;
+	};
+
+	graph &map;
+	SearchContext context;
+	uint32_t version = 0;
+
+	//Most recently used first
+	std::list<Entry> entries;
+	std::unordered_map<uint64_t, std::list<Entry>::iterator> index;
+
+	size_t maxEntries;
+	size_t maxUnits; //Limit on path units kept in total, so memory stays bounded however long the paths are
+	size_t units = 0;
+
+	void erase(std::list<Entry>::iterator e);
+	void evict();
+
+public:
+	std::vector<int> path; //Unit ids of the route of the last findPath, start first
+	float pathCost = 0;
+	int hits = 0;
+	int misses = 0;
+
+	PathCache(graph &map, size_t maxEntries = 4096, size_t maxUnits = 1 << 20);
+	~PathCache();
+	PathCache(const PathCache &) = delete;
+	PathCache &operator=(const PathCache &) = delete;
+
+	void unitChanged(int x, int y) override;
+
+	//Answers from the cache when it can, otherwise searches and remembers the answer
+	bool findPath(Position from, Position to);
+
+	void clear();
+	int size() const { return (int)entries.size(); }
+};
+
+#endif //PATH_CACHE_H
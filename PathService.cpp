@@ -0,0 +1,195 @@
+/*
+File Name : PathService.cpp
+Copyright  2018
+Original authors : Sanketh Bhat
+Written under the supervision of David I.Schwartz, Ph.D., and
+supported by a professional development seed grant from the B.Thomas
+Golisano College of Computing & Information Sciences
+(https ://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software : you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Asynchronous path requests. A pool of worker threads answers them in priority order while the main loop
+keeps running, and the answers come back through a lock-free queue the main loop empties once per frame.
+*/
+
+#include "PathService.h"
+
+//Units a worker expands between checks for cancellation
+static const int CANCEL_CHECK_EXPANSIONS = 4096;
+
+PathService::PathService(const graph &map, int threadCount) : map(map), head(&stub), tail(&stub)
+{
+	if (threadCount <= 0)
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+	contexts.resize(threadCount);
+
+	for (int i = 0; i < threadCount; i++)
+		workers.push_back(std::thread(&PathService::work, this, i));
+}
+
+PathService::~PathService()
+{
+	{
+		std::lock_guard<std::mutex> l(lock);
+		quit = true;
+	}
+	wake.notify_all();
+
+	for (std::thread &t : workers)
+		t.join();
+
+	//Waiting, finished or cancelled, every request is still in live until drain hands it out
+	for (auto &entry : live)
+		delete entry.second;
+}
+
+int PathService::request(Position from, Position to, int priority)
+{
+	Request *r = new Request();
+	r->ticket = nextTicket++;
+	r->priority = priority;
+	r->from = from;
+	r->to = to;
+	live[r->ticket] = r;
+
+	{
+		std::lock_guard<std::mutex> l(lock);
+		waiting.push(r);
+	}
+	wake.notify_one();
+
+	return r->ticket;
+}
+
+bool PathService::cancel(int ticket)
+{
+	auto found = live.find(ticket);
+	if (found == live.end() || found->second->cancelled)
+		return false;
+
+	//A worker that hasn't started it skips it, one that has stops at its next check. Either way
+	//the request still comes back through the queue, where drain drops it.
+	found->second->cancelled = true;
+	return true;
+}
+
+int PathService::drain(const std::function<void(int ticket, PathResult &result)> &deliver)
+{
+	int count = 0;
+	Request *r;
+
+	while ((r = popFinished()) != nullptr)
+	{
+		live.erase(r->ticket);
+
+		if (!r->cancelled)
+		{
+			deliver(r->ticket, r->result);
+			count++;
+		}
+
+		delete r;
+	}
+
+	return count;
+}
+
+//Worker loop: takes the most urgent waiting request, answers it and queues the answer
+void PathService::work(int index)
+{
+	while (true)
+	{
+		Request *r;
+		{
+			std::unique_lock<std::mutex> l(lock);
+			wake.wait(l, [this] { return quit || !waiting.empty(); });
+			if (quit)
+				return;
+
+			r = waiting.top();
+			waiting.pop();
+		}
+
+		if (!r->cancelled)
+			solve(contexts[index], *r);
+
+		finished(r);
+	}
+}
+
+//The search runs in slices with continuePath, so a cancelled request stops soon after it is cancelled
+void PathService::solve(SearchContext &c, Request &r)
+{
+	SearchBudget slice;
+	slice.expansions = CANCEL_CHECK_EXPANSIONS;
+
+	map.startPath(c, r.from, r.to);
+
+	SearchStatus status;
+	while ((status = map.continuePath(c, slice)) == SearchStatus::running)
+		if (r.cancelled.load(std::memory_order_relaxed))
+			return;
+
+	r.result.found = status == SearchStatus::found;
+	r.result.cost = c.stats.pathCost;
+	r.result.path = c.path;
+}
+
+//Producer side of the result queue, called by the workers
+void PathService::finished(Request *r)
+{
+	r->next.store(nullptr, std::memory_order_relaxed);
+	Request *prev = head.exchange(r, std::memory_order_acq_rel);
+	prev->next.store(r, std::memory_order_release);
+}
+
+//Consumer side of the result queue. Returns null when it is empty, or when a worker is halfway through
+//a push; that answer is picked up by the next drain.
+PathService::Request *PathService::popFinished()
+{
+	Request *t = tail;
+	Request *next = t->next.load(std::memory_order_acquire);
+
+	if (t == &stub)
+	{
+		if (!next)
+			return nullptr;
+		tail = next;
+		t = next;
+		next = next->next.load(std::memory_order_acquire);
+	}
+
+	if (next)
+	{
+		tail = next;
+		return t;
+	}
+
+	if (t != head.load(std::memory_order_acquire))
+		return nullptr;
+
+	//t is the last request in the queue. Putting the stub behind it lets t be taken without emptying the queue.
+	finished(&stub);
+	next = t->next.load(std::memory_order_acquire);
+	if (next)
+	{
+		tail = next;
+		return t;
+	}
+
+	return nullptr;
+}
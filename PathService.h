@@ -0,0 +1,106 @@
+/*
+File Name : PathService.h
+Copyright  2018
+Original authors : Sanketh Bhat
+Written under the supervision of David I.Schwartz, Ph.D., and
+supported by a professional development seed grant from the B.Thomas
+Golisano College of Computing & Information Sciences
+(https ://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software : you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Asynchronous path requests. A pool of worker threads answers them in priority order while the main loop
+keeps running, and the answers come back through a lock-free queue the main loop empties once per frame.
+*/
+
+#ifndef PATH_SERVICE_H
+#define PATH_SERVICE_H
+
+#include <functional>
+#include <unordered_map>
+
+#include "PathBatch.h"
+
+//Takes path requests from one thread, usually the main loop, and answers them on worker threads.
+//request, cancel and drain must all be called from that one thread. The graph must not be edited
+//while requests are outstanding, the same as for PathBatch.
+class PathService {
+
+	//One request from the time it is made until drain hands out its answer
+	struct Request {
+		std::atomic<Request*> next; //Link in the result queue
+		int ticket = 0;
+		int priority = 0;
+		Position from = { 0, 0 };
+		Position to = { 0, 0 };
+		std::atomic<bool> cancelled;
+		PathResult result;
+
+		Request() : next(nullptr), cancelled(false) {}
+	};
+
+	//Higher priority first, then the order the requests were made in
+	struct Later {
+		bool operator()(const Request *a, const Request *b) const
+		{
+			return a->priority < b->priority || (a->priority == b->priority && a->ticket > b->ticket);
+		}
+	};
+
+	const graph &map;
+	std::vector<std::thread> workers;
+	std::vector<SearchContext> contexts; //One per worker
+
+	std::mutex lock;
+	std::condition_variable wake; //Workers wait here for requests
+	std::priority_queue<Request*, std::vector<Request*>, Later> waiting; //Requests no worker has taken yet
+	bool quit = false;
+
+	//Finished requests, a multi-producer single-consumer queue (Vyukov). Workers push by swapping head,
+	//drain pops from tail, and neither side ever waits for the other.
+	std::atomic<Request*> head;
+	Request *tail;
+	Request stub; //Keeps the queue from ever being empty
+
+	//Every request not handed out yet, by ticket. Only the requesting thread reads or writes it.
+	std::unordered_map<int, Request*> live;
+	int nextTicket = 1;
+
+	void work(int index);
+	void solve(SearchContext &c, Request &r);
+	void finished(Request *r);
+	Request *popFinished();
+
+public:
+	PathService(const graph &map, int threadCount = 0); //0 uses one thread per core
+	~PathService();
+	PathService(const PathService &) = delete;
+	PathService &operator=(const PathService &) = delete;
+
+	int threads() const { return (int)workers.size(); }
+	int outstanding() const { return (int)live.size(); } //Requests not through drain yet, cancelled ones included
+
+	//Queues a path search and returns its ticket. Higher priorities are searched first.
+	int request(Position from, Position to, int priority = 0);
+
+	//Drops a request, stopping its search if a worker is on it. Its answer is never handed out.
+	//Returns false when the ticket is unknown or its answer was already handed out.
+	bool cancel(int ticket);
+
+	//Hands every answer that has come in to deliver, without waiting for any search. Returns how many.
+	int drain(const std::function<void(int ticket, PathResult &result)> &deliver);
+};
+
+#endif //PATH_SERVICE_H
@@ -0,0 +1,239 @@
+/*
+File Name : Replanner.cpp
+Copyright  2018
+Original authors : Sanketh Bhat
+Written under the supervision of David I.Schwartz, Ph.D., and
+supported by a professional development seed grant from the B.Thomas
+Golisano College of Computing & Information Sciences
+(https ://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software : you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Incremental replanning with D* Lite. The search runs backwards from the goal and keeps its
+costs between calls, so after obstacles change only the units whose costs changed are searched again.
+*/
+
+#include "Replanner.h"
+
+static const float INF = std::numeric_limits<float>::infinity();
+
+Replanner::Replanner(graph &map, Position s, Position t) : map(map)
+{
+	int n = map.width() * map.height();
+
+	start = map.unitId(s.x, s.y);
+	goal = map.unitId(t.x, t.y);
+	last = start;
+
+	g.assign(n, INF);
+	rhs.assign(n, INF);
+	open.resize(n);
+
+	//The search grows out from the goal
+	rhs[goal] = 0;
+	open.push(goal, key(goal));
+
+	map.addListener(this);
+}
+
+Replanner::~Replanner()
+{
+	map.removeListener(this);
+}
+
+void Replanner::unitChanged(int x, int y)
+{
+	changed.push_back(map.unitId(x, y));
+}
+
+void Replanner::moveStart(Position p)
+{
+	start = map.unitId(p.x, p.y);
+}
+
+bool Replanner::replan()
+{
+	expanded = 0;
+
+	//Keys already in the open list were worked out with the old start. Rather than redo them all,
+	//km adds the distance the start moved to every new key, which keeps the comparisons valid.
+	if (start != last)
+	{
+		km += map.estimate(last, start);
+		last = start;
+	}
+
+	//An edited unit changes the cost of every move into or out of it
+	for (int u : changed)
+	{
+		Position p = map.position(u);
+		updateUnit(u);
+
+		for (int i = 0; i < dir; i++)
+		{
+			int x = p.x + dx[i];
+			int y = p.y + dy[i];
+			if (x >= 0 && x < map.width() && y >= 0 && y < map.height())
+				updateUnit(map.unitId(x, y));
+		}
+	}
+	changed.clear();
+
+	computeShortestPath();
+	extractPath();
+
+	return g[start] != INF;
+}
+
+PlanKey Replanner::key(int u) const
+{
+	float m = std::min(g[u], rhs[u]);
+	return { m + map.estimate(u, start) + km, m };
+}
+
+//Cost of the move from a to its neighbor b in direction i. Moves into or out of obstacles can't be made.
+float Replanner::stepCost(int a, int b, int i) const
+{
+	Position pa = map.position(a);
+	Position pb = map.position(b);
+
+	if (!map.passable(pa.x, pa.y) || !map.passable(pb.x, pb.y))
+		return INF;
+	return map.moveCost(a, b, dc[i]);
+}
+
+//Best cost to the goal through any neighbor of u
+float Replanner::lookahead(int u) const
+{
+	Position p = map.position(u);
+	float best = INF;
+
+	for (int i = 0; i < dir; i++)
+	{
+		int x = p.x + dx[i];
+		int y = p.y + dy[i];
+		if (x < 0 || x >= map.width() || y < 0 || y >= map.height())
+			continue;
+
+		int n = map.unitId(x, y);
+		best = std::min(best, stepCost(u, n, i) + g[n]);
+	}
+
+	return best;
+}
+
+//Recomputes rhs of u and puts it in the open list only if it is inconsistent
+void Replanner::updateUnit(int u)
+{
+	if (u != goal)
+		rhs[u] = lookahead(u);
+
+	bool queued = open.contains(u);
+
+	if (g[u] != rhs[u])
+	{
+		if (queued)
+			open.update(u, key(u));
+		else
+			open.push(u, key(u));
+	}
+	else if (queued)
+		open.remove(u);
+}
+
+//Expands inconsistent units in key order until the start is consistent and nothing cheaper is left
+void Replanner::computeShortestPath()
+{
+	while (!open.empty() && (open.top().key < key(start) || rhs[start] != g[start]))
+	{
+		int u = open.top().id;
+		PlanKey oldKey = open.top().key;
+		PlanKey newKey = key(u);
+		expanded++;
+
+		//Queued before the start moved, put it back with an up to date key
+		if (oldKey < newKey)
+		{
+			open.update(u, newKey);
+			continue;
+		}
+
+		if (g[u] > rhs[u])
+		{
+			//Cost went down: settle it, like an ordinary Dijkstra pop
+			g[u] = rhs[u];
+			open.remove(u);
+		}
+		else
+		{
+			//Cost went up: forget it and let the neighbors find the next best route
+			g[u] = INF;
+			updateUnit(u);
+		}
+
+		Position p = map.position(u);
+		for (int i = 0; i < dir; i++)
+		{
+			int x = p.x + dx[i];
+			int y = p.y + dy[i];
+			if (x >= 0 && x < map.width() && y >= 0 && y < map.height())
+				updateUnit(map.unitId(x, y));
+		}
+	}
+}
+
+//Follows the cheapest neighbor from the start to the goal
+void Replanner::extractPath()
+{
+	path.clear();
+	pathCost = 0;
+
+	if (g[start] == INF)
+		return;
+
+	pathCost = g[start];
+
+	int u = start;
+	path.push_back(u);
+
+	for (int steps = 0; u != goal && steps < (int)g.size(); steps++)
+	{
+		Position p = map.position(u);
+		int next = -1;
+		float best = INF;
+
+		for (int i = 0; i < dir; i++)
+		{
+			int x = p.x + dx[i];
+			int y = p.y + dy[i];
+			if (x < 0 || x >= map.width() || y < 0 || y >= map.height())
+				continue;
+
+			int n = map.unitId(x, y);
+			float c = stepCost(u, n, i) + g[n];
+			if (c < best)
+			{
+				best = c;
+				next = n;
+			}
+		}
+
+		if (next == -1)
+			break;
+
+		u = next;
+		path.push_back(u);
+	}
+}
@@ -0,0 +1,87 @@
+/*
+File Name : Replanner.h
+Copyright  2018
+Original authors : Sanketh Bhat
+Written under the supervision of David I.Schwartz, Ph.D., and
+supported by a professional development seed grant from the B.Thomas
+Golisano College of Computing & Information Sciences
+(https ://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software : you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Incremental replanning with D* Lite. The search runs backwards from the goal and keeps its
+costs between calls, so after obstacles change only the units whose costs changed are searched again.
+*/
+
+//Koenig, S. and Likhachev, M. "D* Lite", AAAI 2002
+#ifndef REPLANNER_H
+#define REPLANNER_H
+
+#include "graph.h"
+
+//D* Lite priority, compared first on k1 then on k2
+struct PlanKey {
+	float k1;
+	float k2;
+};
+
+static bool operator<(const PlanKey &A, const PlanKey &B)
+{
+	return A.k1 < B.k1 || (A.k1 == B.k1 && A.k2 < B.k2);
+}
+
+//Keeps a path from a moving start to a fixed goal up to date. It registers itself with the graph,
+//so setObstacle/clearObstacle calls are noted and repaired on the next replan().
+class Replanner : public MapListener {
+
+	graph &map;
+	int start;
+	int goal;
+	int last; //Start at the time of the last replan, for the key modifier
+	float km = 0; //Key modifier, grows as the start moves so old keys stay valid
+
+	//g is the cost to the goal as last expanded, rhs the one-step lookahead from the neighbors' g.
+	//A unit is consistent when they match, and only inconsistent units are in the open list.
+	std::vector<float> g;
+	std::vector<float> rhs;
+	KeyedHeap<PlanKey> open;
+
+	std::vector<int> changed; //Units edited since the last replan
+
+	PlanKey key(int u) const;
+	float stepCost(int a, int b, int i) const;
+	float lookahead(int u) const;
+	void updateUnit(int u);
+	void computeShortestPath();
+	void extractPath();
+
+public:
+	std::vector<int> path; //Unit ids of the route from the start to the goal after the last replan
+	float pathCost = 0;
+	int expanded = 0; //Units expanded by the last replan
+
+	Replanner(graph &map, Position start, Position goal);
+	~Replanner();
+	Replanner(const Replanner &) = delete;
+	Replanner &operator=(const Replanner &) = delete;
+
+	void unitChanged(int x, int y) override;
+	void moveStart(Position p); //The agent moved, usually one step along path
+
+	//Repairs the search for every edit since the last call and rebuilds path. Returns false when the goal can't be reached.
+	bool replan();
+};
+
+#endif //REPLANNER_H
@@ -0,0 +1,128 @@
+/*
+File Name : SearchPolicies.h
+Copyright  2018
+Original authors : Sanketh Bhat
+Written under the supervision of David I.Schwartz, Ph.D., and
+supported by a professional development seed grant from the B.Thomas
+Golisano College of Computing & Information Sciences
+(https ://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software : you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Moves and heuristics for the searches in graph.cpp. The searches are templates on one neighborhood
+and one heuristic policy, so every combination compiles to its own loop with the tables and the
+estimate inlined.
+*/
+
+#ifndef SEARCH_POLICIES_H
+#define SEARCH_POLICIES_H
+
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+
+const int dir = 8; //Number of possible directions we can move
+
+//8 directions
+static int dx[dir] = { 1, 1, 0, -1, -1, -1, 0, 1 };
+static int dy[dir] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+
+//Cost of a move. Diagonals are 14 (10 * sqrt(2), rounded down) so costs stay whole numbers.
+const float STRAIGHT_COST = 10;
+const float DIAGONAL_COST = 14;
+static float dc[dir] = { 10, 14, 10, 14, 10, 14, 10, 14 };
+
+//Selects the neighborhood policy graph::findPath uses
+enum class Neighborhood {
+	four,
+	eight
+};
+
+//Selects the heuristic policy graph::findPath uses
+enum class Heuristic {
+	octile,
+	manhattan,
+	euclidean,
+	none,		//Dijkstra
+	landmarks	//ALT, needs graph::landmarks. Falls back to octile without a usable table.
+};
+
+#pragma region Neighborhoods
+
+//Straight moves only
+struct FourNeighbors {
+	enum { count = 4 };
+
+	static int dx(int i) { static const int t[count] = { 1, 0, -1, 0 }; return t[i]; }
+	static int dy(int i) { static const int t[count] = { 0, 1, 0, -1 }; return t[i]; }
+	static float cost(int i) { return STRAIGHT_COST; }
+};
+
+//Straight and diagonal moves, in the order of the global dx/dy tables
+struct EightNeighbors {
+	enum { count = dir };
+
+	static int dx(int i) { return ::dx[i]; }
+	static int dy(int i) { return ::dy[i]; }
+	static float cost(int i) { return dc[i]; }
+};
+
+#pragma endregion
+
+#pragma region Heuristics
+
+//Each estimate takes the distance to the goal along each axis, both >= 0
+
+//Exact cost on an open 8-connected map: diagonal steps while both axes differ, straight steps for the rest
+struct OctileHeuristic {
+	static float estimate(int xd, int yd)
+	{
+		return DIAGONAL_COST * std::min(xd, yd) + STRAIGHT_COST * std::abs(xd - yd);
+	}
+};
+
+//Exact on an open 4-connected map. It overestimates diagonal moves, so with 8 neighbors
+//it searches greedily and the path may not be the cheapest.
+struct ManhattanHeuristic {
+	static float estimate(int xd, int yd)
+	{
+		return STRAIGHT_COST * (xd + yd);
+	}
+};
+
+//Straight-line distance. Scaled so a diagonal counts DIAGONAL_COST, not 10 * sqrt(2),
+//otherwise it would overestimate the rounded-down diagonal cost.
+struct EuclideanHeuristic {
+	static float estimate(int xd, int yd)
+	{
+		return (DIAGONAL_COST / 1.41421356f) * std::sqrt((float)(xd * xd + yd * yd));
+	}
+};
+
+//No estimate: the search becomes Dijkstra's algorithm
+struct ZeroHeuristic {
+	static float estimate(int xd, int yd)
+	{
+		return 0;
+	}
+};
+
+//Bounds from the landmark table, never below octile. It needs the unit ids rather than the distances,
+//so graph::estimate has its own version for it instead of calling an estimate(xd, yd).
+struct LandmarkHeuristic {};
+
+#pragma endregion
+
+#endif //SEARCH_POLICIES_H
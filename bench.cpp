@@ -0,0 +1,436 @@
+/*
+File Name : bench.cpp
+Copyright  2018
+Original authors : Sanketh Bhat
+Written under the supervision of David I.Schwartz, Ph.D., and
+supported by a professional development seed grant from the B.Thomas
+Golisano College of Computing & Information Sciences
+(https ://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software : you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.If not, see <http://www.gnu.org/licenses/>.
+
+
+Description:
+Headless benchmark for the searches in graph.cpp. Runs every query of one or more scenario files and
+reports units expanded, queries per second, median and 99th percentile latency, and how many costs
+match the optimal ones stored in the file.
+
+Usage: bench [--mode astar|jps|jps+] [--open rebuild|heap|bucket] [--heuristic octile|manhattan|euclidean|none|landmarks]
+             [--landmarks n] [--neighbors 4|8] [--repeat n] [--threads n] scenario...
+
+--heuristic landmarks builds a table of n landmarks (16 by default) before the clock starts.
+Stored costs are for 8 neighbors. With --neighbors 4 the correct costs are worked out first with Dijkstra
+on 4 neighbors, and the answers are checked against those instead.
+
+--threads n solves the queries with PathBatch instead, with 1, 2, 4 ... and n worker threads,
+and reports the queries per second of each thread count and its speedup over one thread.
+
+Scenario file, lines starting with # are ignored:
+	width height
+	one row of the map per line, '.' open and anything else blocked
+	sx sy gx gy optimal		one query per line, optimal is -1 when the goal can't be reached
+
+Files ending in .scen are read as MovingAI scenarios, with the map they name looked for next to them.
+MovingAI lengths forbid corner cutting and count sqrt(2) per diagonal, so they are only upper bounds on the
+costs here. The correct costs are worked out with Dijkstra first, the same as for --neighbors 4, and a
+stored length below the cost Dijkstra finds means the map was read wrong.
+*/
+
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstring>
+
+#include "graph.h"
+#include "MovingAI.h"
+#include "JumpTable.h"
+#include "PathBatch.h"
+#include "Landmarks.h"
+
+//One start/end pair and its known optimal cost
+struct BenchQuery {
+	Position from;
+	Position to;
+	float optimal;
+};
+
+struct Scenario {
+	std::unique_ptr<graph> map;
+	std::vector<BenchQuery> queries;
+	bool exact = true; //false when optimal is only an upper bound, until referenceCosts replaces it
+};
+
+//Settings from the command line, copied onto every graph
+struct BenchSettings {
+	SearchMode mode = SearchMode::aStar;
+	OpenListMode open = OpenListMode::indexedHeap;
+	Heuristic heuristic = Heuristic::octile;
+	Neighborhood neighborhood = Neighborhood::eight;
+	int landmarks = 16; //Landmarks to build for Heuristic::landmarks
+	int repeat = 1;
+	int threads = 0; //Most PathBatch threads, 0 runs the queries one after another on this thread
+};
+
+//Next line that isn't empty or a comment
+static bool nextLine(std::istream &in, std::string &line)
+{
+	while (std::getline(in, line))
+	{
+		if (!line.empty() && line.back() == '\r')
+			line.pop_back();
+		if (!line.empty() && line[0] != '#')
+			return true;
+	}
+	return false;
+}
+
+static bool loadScenario(const char *fileName, Scenario &s)
+{
+	std::ifstream in(fileName);
+	std::string line;
+	int w, h;
+
+	if (!in || !nextLine(in, line) || sscanf(line.c_str(), "%d %d", &w, &h) != 2 || w <= 0 || h <= 0)
+	{
+		fprintf(stderr, "%s: missing map size\n", fileName);
+		return false;
+	}
+
+	s.map.reset(new graph(w, h));
+	for (int y = 0; y < h; y++)
+	{
+		if (!nextLine(in, line) || (int)line.size() < w)
+		{
+			fprintf(stderr, "%s: map row %d is missing or too short\n", fileName, y);
+			return false;
+		}
+		for (int x = 0; x < w; x++)
+			if (line[x] != '.')
+				s.map->setObstacle(x, y);
+	}
+
+	while (nextLine(in, line))
+	{
+		BenchQuery q;
+		if (sscanf(line.c_str(), "%d %d %d %d %f", &q.from.x, &q.from.y, &q.to.x, &q.to.y, &q.optimal) != 5
+			|| q.from.x < 0 || q.from.x >= w || q.from.y < 0 || q.from.y >= h
+			|| q.to.x < 0 || q.to.x >= w || q.to.y < 0 || q.to.y >= h)
+		{
+			fprintf(stderr, "%s: bad query \"%s\"\n", fileName, line.c_str());
+			return false;
+		}
+		s.queries.push_back(q);
+	}
+
+	return true;
+}
+
+static bool loadMovingAI(const char *fileName, Scenario &s)
+{
+	MovingAIScenario scen;
+	if (!loadMovingAIScenario(fileName, scen) || scen.queries.empty())
+	{
+		fprintf(stderr, "%s: not a MovingAI scenario\n", fileName);
+		return false;
+	}
+
+	//The map path is usually relative to the benchmark set, so try it next to the .scen as written and by its name alone
+	std::string file = fileName;
+	std::string dir = file.substr(0, file.find_last_of("/\\") + 1);
+	std::string name = scen.map.substr(scen.map.find_last_of("/\\") + 1);
+
+	s.map = loadMovingAIMap((dir + scen.map).c_str());
+	if (!s.map)
+		s.map = loadMovingAIMap((dir + name).c_str());
+	if (!s.map || s.map->width() != scen.mapWidth || s.map->height() != scen.mapHeight)
+	{
+		fprintf(stderr, "%s: can't load map %s\n", fileName, scen.map.c_str());
+		return false;
+	}
+
+	for (const MovingAIQuery &q : scen.queries)
+		s.queries.push_back({ q.from, q.to, (float)(q.optimal * STRAIGHT_COST) });
+	s.exact = false;
+
+	return true;
+}
+
+//Replaces the stored costs with the ones Dijkstra finds on the given neighborhood, for settings the file wasn't made for
+//and for files that only hold upper bounds. Returns false when a cost on 8 neighbors is over its bound.
+static bool referenceCosts(const char *fileName, Scenario &s, Neighborhood n)
+{
+	graph &map = *s.map;
+	map.searchMode = SearchMode::aStar;
+	map.heuristic = Heuristic::none;
+	map.neighborhood = n;
+
+	SearchContext c;
+	int over = 0;
+	for (BenchQuery &q : s.queries)
+	{
+		float cost = map.findPath(c, q.from, q.to) ? map.cost(c, q.to.x, q.to.y) : -1;
+		//Corner cutting and 14 per diagonal only ever make a route cheaper than its stored length. The small
+		//margin covers the rounding of the stored lengths.
+		if (!s.exact && n == Neighborhood::eight && (cost < 0 || cost > q.optimal + 0.01f))
+		{
+			if (over < 5)
+				fprintf(stderr, "%s: (%d, %d) -> (%d, %d) stored length allows at most %g, Dijkstra found %g\n", fileName,
+					q.from.x, q.from.y, q.to.x, q.to.y, q.optimal, cost);
+			over++;
+		}
+		q.optimal = cost;
+	}
+	s.exact = true;
+
+	return over == 0;
+}
+
+//Value below which p of the sorted samples fall
+static double percentile(const std::vector<double> &sorted, double p)
+{
+	if (sorted.empty())
+		return 0;
+	size_t i = (size_t)(p * (sorted.size() - 1) + 0.5);
+	return sorted[i];
+}
+
+//Checks one answer against the stored cost, and reports the first few wrong ones
+static bool checkAnswer(const char *fileName, const BenchQuery &q, bool found, float cost, int &wrong)
+{
+	//Costs are sums of 10s and 14s, so a correct answer matches exactly
+	bool reachable = q.optimal >= 0;
+	if (found == reachable && (!found || cost == q.optimal))
+		return true;
+
+	if (wrong < 5)
+		fprintf(stderr, "%s: (%d, %d) -> (%d, %d) expected %g, got %g\n", fileName, q.from.x, q.from.y, q.to.x, q.to.y,
+			q.optimal, found ? cost : -1);
+	wrong++;
+	return false;
+}
+
+//Solves the whole scenario with PathBatch at 1, 2, 4 ... and settings.threads threads. Returns false if any answer was wrong.
+static bool runBatch(const char *fileName, const Scenario &s, const BenchSettings &settings)
+{
+	const graph &map = *s.map;
+	std::vector<PathQuery> queries;
+	for (int r = 0; r < settings.repeat; r++)
+		for (const BenchQuery &q : s.queries)
+			queries.push_back({ q.from, q.to });
+
+	std::vector<int> counts;
+	for (int t = 1; t < settings.threads; t *= 2)
+		counts.push_back(t);
+	counts.push_back(settings.threads);
+
+	printf("%s: %dx%d, %d queries x %d, batches on %u cores\n", fileName, map.width(), map.height(), (int)s.queries.size(),
+		settings.repeat, std::thread::hardware_concurrency());
+
+	int wrong = 0;
+	double single = 0;
+	for (int threads : counts)
+	{
+		PathBatch batch(map, threads);
+
+		auto t0 = std::chrono::steady_clock::now();
+		std::vector<PathResult> results = batch.solve(queries);
+		double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+		//Answers are checked once, every thread count solves the same queries
+		if (threads == 1)
+			for (size_t i = 0; i < s.queries.size(); i++)
+				checkAnswer(fileName, s.queries[i], results[i].found, results[i].cost, wrong);
+
+		double rate = ms > 0 ? queries.size() / (ms / 1000) : 0.0;
+		if (threads == 1)
+			single = rate;
+		printf("  threads %-3d %.1f queries/s, %.2fx\n", threads, rate, single > 0 ? rate / single : 0.0);
+	}
+
+	printf("  correct   %d / %d\n", (int)s.queries.size() - wrong, (int)s.queries.size());
+	return wrong == 0;
+}
+
+//Runs every query of one scenario. Returns false if any answer was wrong.
+static bool runScenario(const char *fileName, const Scenario &s, const BenchSettings &settings)
+{
+	graph &map = *s.map;
+
+	map.searchMode = settings.mode;
+	map.openListMode = settings.open;
+	map.heuristic = settings.heuristic;
+	map.neighborhood = settings.neighborhood;
+
+	//Tables are built before the clock starts, JPS+ and ALT pay for them once per map
+	JumpTable table(map);
+	double buildMs = 0;
+	if (settings.mode == SearchMode::jumpPointPlus)
+	{
+		auto t0 = std::chrono::steady_clock::now();
+		table.build();
+		buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+		map.jumpTable = &table;
+	}
+
+	Landmarks landmarks(map);
+	double landmarkMs = 0;
+	if (settings.heuristic == Heuristic::landmarks)
+	{
+		auto t0 = std::chrono::steady_clock::now();
+		landmarks.build(settings.landmarks);
+		landmarkMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+		map.landmarks = &landmarks;
+	}
+
+	if (settings.threads > 0)
+	{
+		bool ok = runBatch(fileName, s, settings);
+		map.jumpTable = nullptr;
+		map.landmarks = nullptr;
+		return ok;
+	}
+
+	SearchContext c;
+	std::vector<double> latency; //ms
+	long long expanded = 0, pushed = 0, decreased = 0, peak = 0;
+	int wrong = 0;
+	double total = 0;
+
+	for (int r = 0; r < settings.repeat; r++)
+		for (const BenchQuery &q : s.queries)
+		{
+			auto t0 = std::chrono::steady_clock::now();
+			bool found = map.findPath(c, q.from, q.to);
+			auto t1 = std::chrono::steady_clock::now();
+
+			double ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+			latency.push_back(ms);
+			total += ms;
+			expanded += c.stats.popped;
+			pushed += c.stats.pushed;
+			decreased += c.stats.decreased;
+			peak = std::max(peak, (long long)c.stats.peakOpen);
+
+			//Each repeat gets the same answers, the first is checked
+			if (r == 0)
+				checkAnswer(fileName, q, found, found ? map.cost(c, q.to.x, q.to.y) : -1, wrong);
+		}
+
+	std::sort(latency.begin(), latency.end());
+	int n = (int)latency.size();
+
+	printf("%s: %dx%d, %d queries x %d\n", fileName, map.width(), map.height(), (int)s.queries.size(), settings.repeat);
+	printf("  correct   %d / %d\n", (int)s.queries.size() - wrong, (int)s.queries.size());
+	if (settings.mode == SearchMode::jumpPointPlus)
+		printf("  jump table built in %.1f ms\n", buildMs);
+	if (settings.heuristic == Heuristic::landmarks)
+		printf("  %d landmarks built in %.1f ms\n", landmarks.count(), landmarkMs);
+	printf("  expanded  %lld total, %.1f per query\n", expanded, n ? (double)expanded / n : 0.0);
+	printf("  open list %.1f pushes, %.1f decrease-keys per query, peak %lld\n", n ? (double)pushed / n : 0.0,
+		n ? (double)decreased / n : 0.0, peak);
+	printf("  speed     %.1f queries/s\n", total > 0 ? n / (total / 1000) : 0.0);
+	printf("  latency   p50 %.4f ms, p99 %.4f ms\n", percentile(latency, 0.5), percentile(latency, 0.99));
+
+	map.jumpTable = nullptr;
+	map.landmarks = nullptr;
+	return wrong == 0;
+}
+
+static void usage()
+{
+	fprintf(stderr, "usage: bench [--mode astar|jps|jps+] [--open rebuild|heap|bucket] [--heuristic octile|manhattan|euclidean|none|landmarks]\n"
+		"             [--landmarks n] [--neighbors 4|8] [--repeat n] [--threads n] scenario...\n");
+}
+
+int main(int argc, char **argv)
+{
+	BenchSettings settings;
+	std::vector<const char *> files;
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		std::string value = i + 1 < argc ? argv[i + 1] : "";
+		bool known = true;
+
+		if (arg == "--mode" && value == "astar")
+			settings.mode = SearchMode::aStar;
+		else if (arg == "--mode" && value == "jps")
+			settings.mode = SearchMode::jumpPoint;
+		else if (arg == "--mode" && value == "jps+")
+			settings.mode = SearchMode::jumpPointPlus;
+		else if (arg == "--open" && value == "rebuild")
+			settings.open = OpenListMode::rebuild;
+		else if (arg == "--open" && value == "heap")
+			settings.open = OpenListMode::indexedHeap;
+		else if (arg == "--open" && value == "bucket")
+			settings.open = OpenListMode::bucket;
+		else if (arg == "--heuristic" && value == "octile")
+			settings.heuristic = Heuristic::octile;
+		else if (arg == "--heuristic" && value == "manhattan")
+			settings.heuristic = Heuristic::manhattan;
+		else if (arg == "--heuristic" && value == "euclidean")
+			settings.heuristic = Heuristic::euclidean;
+		else if (arg == "--heuristic" && value == "none")
+			settings.heuristic = Heuristic::none;
+		else if (arg == "--heuristic" && value == "landmarks")
+			settings.heuristic = Heuristic::landmarks;
+		else if (arg == "--landmarks" && atoi(value.c_str()) > 0)
+			settings.landmarks = atoi(value.c_str());
+		else if (arg == "--neighbors" && (value == "4" || value == "8"))
+			settings.neighborhood = value == "4" ? Neighborhood::four : Neighborhood::eight;
+		else if (arg == "--repeat" && atoi(value.c_str()) > 0)
+			settings.repeat = atoi(value.c_str());
+		else if (arg == "--threads" && atoi(value.c_str()) > 0)
+			settings.threads = atoi(value.c_str());
+		else
+			known = false;
+
+		if (known)
+			i++;
+		else if (arg.compare(0, 2, "--") == 0)
+		{
+			usage();
+			return 2;
+		}
+		else
+			files.push_back(argv[i]);
+	}
+
+	if (files.empty())
+	{
+		usage();
+		return 2;
+	}
+
+	bool ok = true;
+	for (const char *f : files)
+	{
+		Scenario s;
+		size_t length = strlen(f);
+		bool scen = length > 5 && strcmp(f + length - 5, ".scen") == 0;
+
+		if (!(scen ? loadMovingAI(f, s) : loadScenario(f, s)))
+		{
+			ok = false;
+			continue;
+		}
+		if (!s.exact || settings.neighborhood != Neighborhood::eight)
+			ok = referenceCosts(f, s, settings.neighborhood) && ok;
+		ok = runScenario(f, s, settings) && ok;
+	}
+
+	return ok ? 0 : 1;
+}
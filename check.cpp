@@ -0,0 +1,709 @@
+/*
+File Name : check.cpp
+Copyright  2018
+Original authors : Sanketh Bhat
+Written under the supervision of David I.Schwartz, Ph.D., and
+supported by a professional development seed grant from the B.Thomas
+Golisano College of Computing & Information Sciences
+(https ://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software : you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Headless checks for the tables that repair themselves after map edits. Each one is edited at random and
+compared after every batch of edits with the same table built fresh, or with a plain search on the edited map.
+The other ways of answering a query are checked against plain A* the same way.
+Prints every mismatch it finds and exits with 1 if there was any. Runs under ctest.
+
+Usage: check
+*/
+
+#include <cstdio>
+#include <random>
+
+#include "graph.h"
+#include "JumpTable.h"
+#include "FlowField.h"
+#include "Replanner.h"
+#include "PathCache.h"
+#include "Hierarchy.h"
+#include "Landmarks.h"
+#include "Cooperative.h"
+#include "Bidirectional.h"
+#include "PathService.h"
+
+//Prints the first few mismatches of one check and counts them all
+struct CheckLog {
+	const char *name;
+	int failures = 0;
+
+	void fail(const char *what, int x, int y, double expected, double got)
+	{
+		if (failures < 5)
+			printf("%s: %s at (%d, %d), expected %g, got %g\n", name, what, x, y, expected, got);
+		failures++;
+	}
+
+	bool done()
+	{
+		printf("%s: %s\n", name, failures ? "FAILED" : "ok");
+		return failures == 0;
+	}
+};
+
+static void randomMap(graph &map, std::mt19937 &random, int blockedPercent)
+{
+	for (int y = 0; y < map.height(); y++)
+		for (int x = 0; x < map.width(); x++)
+			if ((int)(random() % 100) < blockedPercent)
+				map.setObstacle(x, y);
+}
+
+//Blocks or clears a random unit, or gives it a random weight. Units in keep are left alone.
+static void randomEdit(graph &map, std::mt19937 &random, bool weights, const std::vector<int> &keep)
+{
+	int x, y;
+	do
+	{
+		x = random() % map.width();
+		y = random() % map.height();
+	} while (std::find(keep.begin(), keep.end(), map.unitId(x, y)) != keep.end());
+
+	if (weights && random() % 3 == 0)
+		map.setWeight(x, y, (uint8_t)(1 + random() % 4));
+	else if (map.passable(x, y))
+		map.setObstacle(x, y);
+	else
+		map.clearObstacle(x, y);
+}
+
+//Every jump the repaired table gives must be the one a freshly built table gives
+static bool checkJumpTable()
+{
+	CheckLog log = { "jump table repair" };
+	std::mt19937 random(22);
+	graph map(64, 48);
+	randomMap(map, random, 25);
+
+	JumpTable table(map);
+	table.build();
+
+	for (int edit = 0; edit < 300 && log.failures == 0; edit++)
+	{
+		randomEdit(map, random, false, {});
+
+		JumpTable fresh(map);
+		fresh.build();
+		for (int y = 0; y < map.height(); y++)
+			for (int x = 0; x < map.width(); x++)
+				for (int i = 0; i < dir && map.passable(x, y); i++)
+				{
+					int expected = fresh.jump(x, y, dx[i], dy[i], -1);
+					int got = table.jump(x, y, dx[i], dy[i], -1);
+					if (got != expected)
+						log.fail("jump", x, y, expected, got);
+				}
+	}
+
+	return log.done();
+}
+
+//After update() every cost and step must be the ones a new field on the edited map has
+static bool checkFlowField()
+{
+	CheckLog log = { "flow field repair" };
+	std::mt19937 random(19);
+	graph map(40, 40);
+	randomMap(map, random, 20);
+
+	Position goal = { 20, 20 };
+	map.clearObstacle(goal.x, goal.y);
+	FlowField field(map, goal);
+
+	for (int batch = 0; batch < 200 && log.failures == 0; batch++)
+	{
+		int edits = 1 + random() % 5;
+		for (int i = 0; i < edits; i++)
+			randomEdit(map, random, true, { map.unitId(goal.x, goal.y) });
+
+		//Now and then the goal itself is blocked, cleared or reweighted
+		if (batch % 20 == 9)
+			map.setObstacle(goal.x, goal.y);
+		else if (batch % 20 == 19)
+			map.clearObstacle(goal.x, goal.y);
+		else if (batch % 10 == 4)
+			map.setWeight(goal.x, goal.y, (uint8_t)(1 + random() % 4));
+		field.update();
+
+		FlowField fresh(map, goal);
+		for (int y = 0; y < map.height(); y++)
+			for (int x = 0; x < map.width(); x++)
+			{
+				int u = map.unitId(x, y);
+				if (field.distance(u) != fresh.distance(u))
+					log.fail("distance", x, y, fresh.distance(u), field.distance(u));
+				else if (field.next(u) != fresh.next(u))
+					log.fail("next unit", x, y, fresh.next(u), field.next(u));
+			}
+	}
+
+	return log.done();
+}
+
+//The repaired D* Lite route must cost what A* finds on the edited map, while the start walks along it
+static bool checkReplanner()
+{
+	CheckLog log = { "D* Lite repair" };
+	std::mt19937 random(8);
+	graph map(48, 48);
+	randomMap(map, random, 20);
+
+	Position start = { 2, 2 };
+	Position goal = { 45, 45 };
+	map.clearObstacle(start.x, start.y);
+	map.clearObstacle(goal.x, goal.y);
+	Replanner planner(map, start, goal);
+	SearchContext c;
+
+	for (int batch = 0; batch < 200 && log.failures == 0; batch++)
+	{
+		int edits = 1 + random() % 5;
+		for (int i = 0; i < edits; i++)
+			randomEdit(map, random, true, { map.unitId(start.x, start.y), map.unitId(goal.x, goal.y) });
+
+		bool found = planner.replan();
+		bool expected = map.findPath(c, start, goal);
+		if (found != expected)
+			log.fail("goal reached", start.x, start.y, expected, found);
+		else if (found && planner.pathCost != c.stats.pathCost)
+			log.fail("path cost", start.x, start.y, c.stats.pathCost, planner.pathCost);
+
+		//Walk one step on, back to the corner once the goal is reached
+		if (found && planner.path.size() > 1)
+			start = map.position(planner.path[1]);
+		else if (found)
+			start = { 2, 2 };
+		map.clearObstacle(start.x, start.y);
+		planner.moveStart(start);
+	}
+
+	return log.done();
+}
+
+//Routes through the rebuilt clusters must cost what they cost through a hierarchy built fresh
+static bool checkHierarchy()
+{
+	CheckLog log = { "hierarchy repair" };
+	std::mt19937 random(7);
+	graph map(70, 50);
+	randomMap(map, random, 25);
+
+	Hierarchy hierarchy(map, 8);
+
+	for (int batch = 0; batch < 100 && log.failures == 0; batch++)
+	{
+		int edits = 1 + random() % 5;
+		for (int i = 0; i < edits; i++)
+			randomEdit(map, random, true, {});
+
+		Hierarchy fresh(map, 8);
+		for (int query = 0; query < 10; query++)
+		{
+			Position from = { (int)(random() % 70), (int)(random() % 50) };
+			Position to = { (int)(random() % 70), (int)(random() % 50) };
+			bool found = hierarchy.findPath(from, to);
+			bool expected = fresh.findPath(from, to);
+			if (found != expected)
+				log.fail("goal reached", from.x, from.y, expected, found);
+			else if (found && hierarchy.pathCost != fresh.pathCost)
+				log.fail("path cost", from.x, from.y, fresh.pathCost, hierarchy.pathCost);
+		}
+	}
+
+	return log.done();
+}
+
+//Answers served from the cache must match a fresh search on the edited map
+static bool checkPathCache()
+{
+	CheckLog log = { "path cache invalidation" };
+	std::mt19937 random(18);
+	graph map(48, 48);
+	randomMap(map, random, 20);
+
+	//Few enough pairs that most queries are hits
+	std::vector<Position> ends;
+	for (int i = 0; i < 8; i++)
+	{
+		ends.push_back({ (int)(random() % 48), (int)(random() % 48) });
+		map.clearObstacle(ends.back().x, ends.back().y);
+	}
+	std::vector<int> keep;
+	for (Position p : ends)
+		keep.push_back(map.unitId(p.x, p.y));
+
+	PathCache cache(map);
+	SearchContext c;
+
+	for (int query = 0; query < 2000 && log.failures == 0; query++)
+	{
+		if (random() % 4 == 0)
+			randomEdit(map, random, true, keep);
+
+		Position from = ends[random() % ends.size()];
+		Position to = ends[random() % ends.size()];
+		bool found = cache.findPath(from, to);
+		bool expected = map.findPath(c, from, to);
+		if (found != expected)
+			log.fail("goal reached", from.x, from.y, expected, found);
+		else if (found && cache.pathCost != c.stats.pathCost)
+			log.fail("path cost", from.x, from.y, c.stats.pathCost, cache.pathCost);
+	}
+
+	if (cache.hits == 0)
+		log.fail("cache hits", 0, 0, 1, 0);
+	return log.done();
+}
+
+//A saved landmark table only loads into the map it was measured on, and a stale one isn't saved at all
+static bool checkLandmarkFiles()
+{
+	CheckLog log = { "landmark files" };
+	const char *file = "check_landmarks.tmp";
+
+	graph walled(30, 30);
+	for (int y = 0; y < 29; y++)
+		walled.setObstacle(15, y);
+	graph open(30, 30);
+
+	Landmarks saved(walled);
+	saved.build(4);
+	if (!saved.save(file))
+		log.fail("save", 0, 0, 1, 0);
+
+	Landmarks same(walled);
+	if (!same.load(file))
+		log.fail("load into the same map", 0, 0, 1, 0);
+
+	Landmarks other(open);
+	if (other.load(file))
+		log.fail("load into another map of the same size", 0, 0, 0, 1);
+
+	walled.setWeight(3, 3, 2);
+	if (same.load(file))
+		log.fail("load after a weight edit", 3, 3, 0, 1);
+
+	walled.clearObstacle(15, 10);
+	if (saved.save(file))
+		log.fail("save of a stale table", 15, 10, 0, 1);
+
+	remove(file);
+	return log.done();
+}
+
+//Every search mode and open list must find routes of the cost plain A* finds, on uniform maps where the jump
+//searches run and on weighted ones where they fall back to A*
+static bool checkSearchModes()
+{
+	CheckLog log = { "search modes" };
+	std::mt19937 random(16);
+	graph map(48, 48);
+	randomMap(map, random, 25);
+
+	JumpTable table(map);
+	table.build();
+	map.jumpTable = &table;
+
+	const SearchMode modes[] = { SearchMode::aStar, SearchMode::jumpPoint, SearchMode::jumpPointPlus };
+	const OpenListMode lists[] = { OpenListMode::rebuild, OpenListMode::indexedHeap, OpenListMode::bucket };
+	SearchContext c, reference;
+
+	for (int query = 0; query < 300 && log.failures == 0; query++)
+	{
+		//Half way through the map gets weights
+		if (query == 150)
+			for (int i = 0; i < 250; i++)
+				map.setWeight(random() % 48, random() % 48, (uint8_t)(1 + random() % 4));
+
+		Position from = { (int)(random() % 48), (int)(random() % 48) };
+		Position to = { (int)(random() % 48), (int)(random() % 48) };
+		map.searchMode = SearchMode::aStar;
+		map.openListMode = OpenListMode::indexedHeap;
+		bool expected = map.findPath(reference, from, to);
+
+		for (SearchMode mode : modes)
+			for (OpenListMode list : lists)
+			{
+				map.searchMode = mode;
+				map.openListMode = list;
+				bool found = map.findPath(c, from, to);
+				if (found != expected)
+					log.fail("goal reached", from.x, from.y, expected, found);
+				else if (found && c.stats.pathCost != reference.stats.pathCost)
+					log.fail("path cost", from.x, from.y, reference.stats.pathCost, c.stats.pathCost);
+			}
+	}
+
+	return log.done();
+}
+
+//Cost of walking a route unit by unit, infinity if a step isn't a move the map allows to a passable neighbor
+static float routeCost(const graph &map, const std::vector<int> &path)
+{
+	float cost = 0;
+	for (size_t i = 1; i < path.size(); i++)
+	{
+		Position p = map.position(path[i - 1]);
+		Position q = map.position(path[i]);
+		int dx = std::abs(q.x - p.x), dy = std::abs(q.y - p.y);
+		bool diagonal = dx + dy == 2;
+		if (dx > 1 || dy > 1 || dx + dy == 0 || (diagonal && map.neighborhood == Neighborhood::four) || !map.passable(q.x, q.y))
+			return std::numeric_limits<float>::infinity();
+		cost += map.moveCost(path[i - 1], path[i], diagonal ? DIAGONAL_COST : STRAIGHT_COST);
+	}
+	return cost;
+}
+
+//The two frontiers must meet on a route as cheap as the one plain A* finds, and the route must be walkable
+static bool checkBidirectional()
+{
+	CheckLog log = { "bidirectional search" };
+	std::mt19937 random(12);
+	graph map(64, 64);
+	randomMap(map, random, 25);
+
+	Bidirectional search(map);
+	SearchContext c;
+
+	for (int query = 0; query < 600 && log.failures == 0; query++)
+	{
+		//A third of the queries on a uniform map, a third weighted, a third weighted with four neighbors
+		if (query == 200)
+			for (int i = 0; i < 400; i++)
+				map.setWeight(random() % 64, random() % 64, (uint8_t)(1 + random() % 4));
+		if (query == 400)
+			map.neighborhood = Neighborhood::four;
+
+		Position from = { (int)(random() % 64), (int)(random() % 64) };
+		Position to = { (int)(random() % 64), (int)(random() % 64) };
+		bool expected = map.findPath(c, from, to);
+		bool found = search.findPath(from, to);
+		if (found != expected)
+			log.fail("goal reached", from.x, from.y, expected, found);
+		else if (found && search.pathCost != c.stats.pathCost)
+			log.fail("path cost", from.x, from.y, c.stats.pathCost, search.pathCost);
+		else if (found && (search.path.front() != c.start || search.path.back() != c.goal || routeCost(map, search.path) != search.pathCost))
+			log.fail("route", from.x, from.y, search.pathCost, routeCost(map, search.path));
+	}
+
+	return log.done();
+}
+
+//A search run a slice at a time must end the way findPath does, and every partial route on the way must be
+//walkable from the start
+static bool checkBudgetedSearch()
+{
+	CheckLog log = { "budgeted search" };
+	std::mt19937 random(23);
+	graph map(64, 64);
+	randomMap(map, random, 25);
+	for (int i = 0; i < 400; i++)
+		map.setWeight(random() % 64, random() % 64, (uint8_t)(1 + random() % 4));
+
+	SearchContext c, reference;
+
+	for (int query = 0; query < 300 && log.failures == 0; query++)
+	{
+		Position from = { (int)(random() % 64), (int)(random() % 64) };
+		Position to = { (int)(random() % 64), (int)(random() % 64) };
+		bool expected = map.findPath(reference, from, to);
+
+		//Every other query is cut by time instead of by count
+		SearchBudget budget;
+		if (query % 2)
+			budget.microseconds = 5;
+		else
+			budget.expansions = 1 + random() % 64;
+
+		map.startPath(c, from, to);
+		SearchStatus status;
+		while ((status = map.continuePath(c, budget)) == SearchStatus::running)
+			if (c.path.empty() || c.path.front() != c.start || routeCost(map, c.path) == std::numeric_limits<float>::infinity())
+				log.fail("partial route", from.x, from.y, 1, 0);
+
+		bool found = status == SearchStatus::found;
+		if (found != expected)
+			log.fail("goal reached", from.x, from.y, expected, found);
+		else if (found && c.stats.pathCost != reference.stats.pathCost)
+			log.fail("path cost", from.x, from.y, reference.stats.pathCost, c.stats.pathCost);
+		else if (found && routeCost(map, c.path) != c.stats.pathCost)
+			log.fail("route", from.x, from.y, c.stats.pathCost, routeCost(map, c.path));
+	}
+
+	return log.done();
+}
+
+//Whether the segment between the centers of a and b touches the square of unit u, edges and corners included.
+//Worked in half units so it's exact: the segment crosses the square unless all four corners lie strictly on
+//one side of its line.
+static bool touches(Position a, Position b, Position u)
+{
+	long long side[4];
+	for (int i = 0; i < 4; i++)
+	{
+		long long cx = 2 * u.x + (i & 1 ? 1 : -1) - 2 * a.x;
+		long long cy = 2 * u.y + (i & 2 ? 1 : -1) - 2 * a.y;
+		side[i] = (long long)(b.x - a.x) * cy - (long long)(b.y - a.y) * cx;
+	}
+	bool above = side[0] > 0 && side[1] > 0 && side[2] > 0 && side[3] > 0;
+	bool below = side[0] < 0 && side[1] < 0 && side[2] < 0 && side[3] < 0;
+	return !above && !below;
+}
+
+//The word at a time line test must agree with testing every unit the segment touches
+static bool checkLineOfSight()
+{
+	CheckLog log = { "line of sight" };
+	std::mt19937 random(21);
+	graph map(150, 100);
+	randomMap(map, random, 3);
+
+	for (int query = 0; query < 20000 && log.failures == 0; query++)
+	{
+		//Long lines cross word boundaries, short steep ones land on unit corners often
+		int reach = query % 2 ? 140 : 6;
+		Position a = { (int)(random() % 150), (int)(random() % 100) };
+		Position b = { a.x + (int)(random() % (2 * reach + 1)) - reach, a.y + (int)(random() % (2 * reach + 1)) - reach };
+		b.x = std::max(0, std::min(149, b.x));
+		b.y = std::max(0, std::min(99, b.y));
+
+		bool expected = true;
+		for (int y = std::min(a.y, b.y); y <= std::max(a.y, b.y) && expected; y++)
+			for (int x = std::min(a.x, b.x); x <= std::max(a.x, b.x) && expected; x++)
+				if (!map.passable(x, y) && touches(a, b, { x, y }))
+					expected = false;
+
+		bool got = map.lineOfSight(a, b);
+		if (got != expected)
+			log.fail("line of sight", a.x, a.y, expected, got);
+	}
+
+	return log.done();
+}
+
+//Every request not cancelled must come back exactly once with the answer findPath gives, and no cancelled
+//one may come back at all. Some are cancelled before a worker takes them, some while one is on them.
+static bool checkPathService()
+{
+	CheckLog log = { "path service" };
+	std::mt19937 random(24);
+	graph map(96, 96);
+	randomMap(map, random, 25);
+
+	PathService service(map, 3);
+	SearchContext c;
+
+	for (int round = 0; round < 20 && log.failures == 0; round++)
+	{
+		std::unordered_map<int, PathQuery> asked;
+		std::vector<int> cancelled;
+		for (int i = 0; i < 50; i++)
+		{
+			PathQuery q = { { (int)(random() % 96), (int)(random() % 96) }, { (int)(random() % 96), (int)(random() % 96) } };
+			int ticket = service.request(q.from, q.to, (int)(random() % 3));
+			asked[ticket] = q;
+			if (random() % 4 == 0)
+			{
+				if (!service.cancel(ticket))
+					log.fail("cancel", q.from.x, q.from.y, 1, 0);
+				cancelled.push_back(ticket);
+			}
+		}
+
+		//Cancel a few more while the workers are busy, unless they already answered
+		std::unordered_map<int, PathResult> answers;
+		auto deliver = [&](int ticket, PathResult &result) {
+			if (answers.count(ticket))
+				log.fail("answered twice", ticket, 0, 1, 2);
+			answers[ticket] = result;
+		};
+		for (auto &q : asked)
+			if (random() % 8 == 0 && service.cancel(q.first))
+				cancelled.push_back(q.first);
+
+		while (service.outstanding() > 0)
+		{
+			service.drain(deliver);
+			std::this_thread::yield();
+		}
+
+		for (int ticket : cancelled)
+		{
+			if (answers.count(ticket))
+				log.fail("cancelled request answered", ticket, 0, 0, 1);
+			if (service.cancel(ticket))
+				log.fail("cancel of a finished request", ticket, 0, 0, 1);
+			asked.erase(ticket);
+		}
+
+		for (auto &q : asked)
+		{
+			auto answer = answers.find(q.first);
+			if (answer == answers.end())
+			{
+				log.fail("request never answered", q.second.from.x, q.second.from.y, 1, 0);
+				continue;
+			}
+			bool expected = map.findPath(c, q.second.from, q.second.to);
+			if (answer->second.found != expected)
+				log.fail("goal reached", q.second.from.x, q.second.from.y, expected, answer->second.found);
+			else if (expected && answer->second.cost != c.stats.pathCost)
+				log.fail("path cost", q.second.from.x, q.second.from.y, c.stats.pathCost, answer->second.cost);
+		}
+	}
+
+	return log.done();
+}
+
+//Each result of a batch must sit at the index of its query and hold that query's answer, whatever order
+//the workers took the queries in and however many batches the pool has solved before
+static bool checkPathBatch()
+{
+	CheckLog log = { "path batch" };
+	std::mt19937 random(6);
+	graph map(80, 80);
+	randomMap(map, random, 25);
+
+	PathBatch batch(map, 4);
+	SearchContext c;
+
+	for (int round = 0; round < 30 && log.failures == 0; round++)
+	{
+		std::vector<PathQuery> queries(round % 10 == 0 ? round / 10 : 40);
+		for (PathQuery &q : queries)
+			q = { { (int)(random() % 80), (int)(random() % 80) }, { (int)(random() % 80), (int)(random() % 80) } };
+
+		std::vector<PathResult> results = batch.solve(queries);
+		if (results.size() != queries.size())
+		{
+			log.fail("result count", 0, 0, (double)queries.size(), (double)results.size());
+			continue;
+		}
+
+		for (size_t i = 0; i < queries.size(); i++)
+		{
+			const PathQuery &q = queries[i];
+			const PathResult &r = results[i];
+			bool expected = map.findPath(c, q.from, q.to);
+			if (r.found != expected)
+				log.fail("goal reached", q.from.x, q.from.y, expected, r.found);
+			else if (expected && r.cost != c.stats.pathCost)
+				log.fail("path cost", q.from.x, q.from.y, c.stats.pathCost, r.cost);
+			else if (expected && (r.path.front() != c.start || r.path.back() != c.goal))
+				log.fail("route ends", q.from.x, q.from.y, c.goal, r.path.back());
+		}
+	}
+
+	return log.done();
+}
+
+//Runs agents between random units and fails on any two sharing a unit or swapping, with the map edited
+//every five ticks when edits is set
+static void runAgents(CheckLog &log, std::mt19937 &random, int size, int percent, int count, bool edits)
+{
+	graph map(size, size);
+	randomMap(map, random, percent);
+
+	Cooperative agents(map, 16);
+	agents.maxGoalTables = 8;
+
+	std::vector<int> used;
+	while (agents.agentCount() < count)
+	{
+		Position from = { (int)(random() % size), (int)(random() % size) };
+		Position to = { (int)(random() % size), (int)(random() % size) };
+		int u = map.unitId(from.x, from.y);
+		if (!map.passable(from.x, from.y) || std::find(used.begin(), used.end(), u) != used.end())
+			continue;
+		used.push_back(u);
+		agents.addAgent(from, to);
+	}
+
+	std::vector<Position> before(agents.agentCount());
+	for (int tick = 0; tick < 300 && log.failures == 0; tick++)
+	{
+		for (int i = 0; i < agents.agentCount(); i++)
+			before[i] = agents.position(i);
+
+		//Edits land away from the agents, a unit blocked under one would be a collision by definition
+		if (edits && tick % 5 == 0)
+			randomEdit(map, random, true, used);
+		agents.step();
+
+		std::vector<int> at(map.width() * map.height(), -1);
+		for (int i = 0; i < agents.agentCount(); i++)
+		{
+			Position p = agents.position(i);
+			int u = map.unitId(p.x, p.y);
+			used[i] = u;
+			if (std::abs(p.x - before[i].x) > 1 || std::abs(p.y - before[i].y) > 1)
+				log.fail("move longer than a step", p.x, p.y, 1, std::max(std::abs(p.x - before[i].x), std::abs(p.y - before[i].y)));
+			if (at[u] != -1)
+				log.fail("two agents in one unit", p.x, p.y, at[u], i);
+			at[u] = i;
+		}
+
+		for (int i = 0; i < agents.agentCount(); i++)
+		{
+			Position p = agents.position(i);
+			int j = at[map.unitId(before[i].x, before[i].y)];
+			if (j != -1 && j != i && agents.position(j) == before[i] && before[j] == p)
+				log.fail("agents swapped units", p.x, p.y, i, j);
+		}
+	}
+}
+
+//Cooperative agents must never share a unit or swap units, while the map is edited around them and with
+//fewer distance tables than goals
+static bool checkCooperative()
+{
+	CheckLog log = { "cooperative agents" };
+	std::mt19937 random(25);
+	runAgents(log, random, 48, 15, 150, true);
+
+	//Crowded: about a third of the open units hold an agent, so plans often end where others need to pass
+	for (int seed = 0; seed < 4 && log.failures == 0; seed++)
+		runAgents(log, random, 24, 30, 120, false);
+
+	return log.done();
+}
+
+int main()
+{
+	bool ok = checkJumpTable();
+	ok = checkFlowField() && ok;
+	ok = checkReplanner() && ok;
+	ok = checkHierarchy() && ok;
+	ok = checkPathCache() && ok;
+	ok = checkLandmarkFiles() && ok;
+	ok = checkCooperative() && ok;
+	ok = checkSearchModes() && ok;
+	ok = checkBidirectional() && ok;
+	ok = checkBudgetedSearch() && ok;
+	ok = checkLineOfSight() && ok;
+	ok = checkPathService() && ok;
+	ok = checkPathBatch() && ok;
+
+	return ok ? 0 : 1;
+}
@@ -25,6 +25,8 @@ C++ demonstration of the A* pathfinding algorithm
 */
 
 #include "graph.h"
+#include "Landmarks.h"
+#include "JumpTable.h"
 
 
 #pragma region Graph Generation
@@ -35,128 +37,682 @@ void graph::initMap(int oCount)
 {
 	srand(time(NULL));
 	int x, y;
-	for (int i = 0; i < S; i++)
+	passGrid.resize(w, h);
+	weight.assign(w * h, 1);
+	std::fill(weightCount, weightCount + 256, 0);
+	weightCount[1] = w * h;
+	minWeight = maxWeight = 1;
+	context.resize(w * h);
+}
+
+
+void graph::aStarPF()
+{
+	findPath(start, end);
+
+	printGraph();
+	printStats();
+}
+
+//Runs one query on the map with the graph's own search context.
+//Returns false when the end can't be reached.
+bool graph::findPath(Position from, Position to)
+{
+	start = from;
+	end = to;
+
+	bool found = findPath(context, from, to);
+	path = context.path;
+
+	return found;
+}
+
+//Runs one query using the search data in c, leaving the graph untouched. The unit arrays in c are reused,
+//so a context can answer any number of queries, and threads with their own contexts can share one graph.
+bool graph::findPath(SearchContext &c, Position from, Position to) const
+{
+	startPath(c, from, to);
+	return continuePath(c, SearchBudget()) == SearchStatus::found;
+}
+
+//Sets c up for a query without expanding anything yet
+void graph::startPath(SearchContext &c, Position from, Position to) const
+{
+	c.resize(w * h);
+	c.newSearch();
+	c.start = unitId(from.x, from.y);
+	c.goal = unitId(to.x, to.y);
+	c.path.clear();
+	c.status = SearchStatus::running;
+	c.nearest = c.start;
+	c.nearestDistance = estimate(c.start, c.goal);
+}
+
+SearchStatus graph::continuePath(SearchContext &c, const SearchBudget &budget) const
+{
+	if (c.status != SearchStatus::running)
+		return c.status;
+
+	auto began = std::chrono::steady_clock::now();
+
+	SearchLimit limit;
+	int expansions = std::max(budget.expansions, 1);
+	limit.popped = expansions > std::numeric_limits<int>::max() - c.stats.popped ? std::numeric_limits<int>::max() : c.stats.popped + expansions;
+	limit.timed = budget.microseconds != std::numeric_limits<double>::infinity();
+	if (limit.timed)
+		limit.deadline = began + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double, std::micro>(budget.microseconds));
+	limit.partial = limit.timed || limit.popped != std::numeric_limits<int>::max();
+
+	bool over = false;
+	switch (openListMode)
 	{
-		for (int j = 0; j < S; j++)
-		{
-			map[i][j].pos.x = i;
-			map[i][j].pos.y = j;
-			map[i][j].status = ".";
-			pMap[i][j] = 0;
-		}
+	case OpenListMode::rebuild:
+		over = runSearch(c, c.openUnits, limit);
+		break;
+	case OpenListMode::indexedHeap:
+		over = runSearch(c, c.openHeap, limit);
+		break;
+	case OpenListMode::bucket:
+		over = runSearch(c, c.openBuckets, limit);
+		break;
+	}
 
+	if (!over)
+		buildPath(c, c.nearest);
+	else if (c.listStatus(c.goal) == ListStatus::closed)
+	{
+		c.status = SearchStatus::found;
+		buildPath(c, c.goal);
+		c.stats.pathLength = (int)c.path.size();
+		c.stats.pathCost = c.g[c.goal];
 	}
-	
-	
+	else
+	{
+		c.status = SearchStatus::unreachable;
+		c.path.clear();
+	}
+
+	c.stats.milliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - began).count();
+
+	return c.status;
 }
 
+void graph::startPath(Position from, Position to)
+{
+	start = from;
+	end = to;
+	path.clear();
 
-void graph::aStarPF()
+	startPath(context, from, to);
+}
+
+SearchStatus graph::continuePath(const SearchBudget &budget)
 {
-	map[start.x][start.y].status = "S";
-	map[end.x][end.y].status = "F";
+	SearchStatus s = continuePath(context, budget);
+	path = context.path;
 
-	std::priority_queue<Unit> temp;
-	int i, x, y;
-	Unit u;
-	Unit n;
+	return s;
+}
+
+//Follows the parents back from an expanded unit, so the route costs time and memory in proportion to its length,
+//not to the number of units searched. JPS parents can be several units apart along a line, so the units
+//in between are filled in.
+void graph::buildPath(SearchContext &c, int end) const
+{
+	c.path.clear();
+
+	for (int u = end; u != -1; u = c.parent[u])
+	{
+		c.path.push_back(u);
 
-	//Initlaizing the start unit in the queue
-	map[start.x][start.y].estimatePriority(end.x, end.y);
-	pMap[start.x][start.y] = map[start.x][start.y].f;
+		if (c.parent[u] == -1)
+			break;
 
-	openUnits.push(map[start.x][start.y]);
+		Position a = position(u);
+		Position b = position(c.parent[u]);
+		int sx = (b.x > a.x) - (b.x < a.x);
+		int sy = (b.y > a.y) - (b.y < a.y);
 
-	while (!openUnits.empty())
+		for (int x = a.x + sx, y = a.y + sy; x != b.x || y != b.y; x += sx, y += sy)
+			c.path.push_back(unitId(x, y));
+	}
+
+	std::reverse(c.path.begin(), c.path.end());
+}
+
+//Picks the compiled search for the current settings. Each combination of open list, heuristic and
+//neighborhood is its own instantiation, so the settings are only looked at once per query.
+template<class OpenList>
+bool graph::runSearch(SearchContext &c, OpenList &openList, const SearchLimit &limit) const
+{
+	switch (heuristic)
 	{
-		u = openUnits.top();
+	case Heuristic::manhattan:
+		return runSearch<ManhattanHeuristic>(c, openList, limit);
+	case Heuristic::euclidean:
+		return runSearch<EuclideanHeuristic>(c, openList, limit);
+	case Heuristic::none:
+		return runSearch<ZeroHeuristic>(c, openList, limit);
+	case Heuristic::landmarks:
+		if (landmarks && landmarks->usable(neighborhood))
+			return runSearch<LandmarkHeuristic>(c, openList, limit);
+		return runSearch<OctileHeuristic>(c, openList, limit);
+	default:
+		return runSearch<OctileHeuristic>(c, openList, limit);
+	}
+}
 
-		openUnits.pop();
-		map[u.pos.x][u.pos.y].closed = true;
-		path.push_back(u);
+template<class H, class OpenList>
+bool graph::runSearch(SearchContext &c, OpenList &openList, const SearchLimit &limit) const
+{
+	//Jump points skip over units without looking at them, which is only right when every unit costs the same
+	if (neighborhood == Neighborhood::four)
+		return search<FourNeighbors, H>(c, openList, limit);
+	else if ((searchMode == SearchMode::jumpPoint || searchMode == SearchMode::jumpPointPlus) && uniformWeights())
+		return jumpSearch<H>(c, openList, limit);
+	else
+		return search<EightNeighbors, H>(c, openList, limit);
+}
+
+//No move is cheaper than the distance at the lowest weight on the map, so scaling by it keeps the estimate a lower bound
+template<class H>
+float graph::estimate(int id, int goal) const
+{
+	Position p = position(id);
+	Position e = position(goal);
 
-		if (u.status == "F")
+	return H::estimate(abs(e.x - p.x), abs(e.y - p.y)) * minWeight;
+}
+
+//Both bounds are consistent, so their maximum is too
+template<>
+float graph::estimate<LandmarkHeuristic>(int id, int goal) const
+{
+	return std::max(estimate<OctileHeuristic>(id, goal), landmarks->estimate(id, goal));
+}
+
+//Puts the start unit in an empty open list
+template<class H, class OpenList>
+void graph::openStart(SearchContext &c, OpenList &openList) const
+{
+	openList.clear();
+
+	int s = c.start;
+	c.stamp[s] = c.generation;
+	c.g[s] = 0;
+	c.parent[s] = -1;
+	c.list[s] = ListStatus::open;
+
+	openList.push(s, estimate<H>(s, c.goal));
+	c.stats.pushed = 1;
+	c.stats.peakOpen = 1;
+	c.opened = true;
+}
+
+//Checked after each expansion. Reading the clock costs more than an expansion, so it's only read every 64.
+inline bool graph::outOfBudget(const SearchContext &c, const SearchLimit &limit)
+{
+	return c.stats.popped >= limit.popped ||
+		(limit.timed && (c.stats.popped & 63) == 0 && std::chrono::steady_clock::now() >= limit.deadline);
+}
+
+//Keeps the expanded unit closest to the goal e, where the partial route of an unfinished search ends
+static inline void keepNearest(SearchContext &c, int u, Position p, Position e)
+{
+	float d = OctileHeuristic::estimate(abs(e.x - p.x), abs(e.y - p.y));
+	if (d < c.nearestDistance)
+	{
+		c.nearest = u;
+		c.nearestDistance = d;
+	}
+}
+
+//Offers unit n a route through u that costs ng. n must not be closed.
+template<class H, class OpenList>
+void graph::relax(SearchContext &c, OpenList &openList, int u, int n, float ng) const
+{
+	//If this unit is not in the open list,add it
+	if (c.listStatus(n) != ListStatus::open)
+	{
+		c.stamp[n] = c.generation;
+		c.list[n] = ListStatus::open;
+		c.g[n] = ng;
+		c.parent[n] = u;
+		openList.push(n, ng + estimate<H>(n, c.goal));
+		c.stats.pushed++;
+		c.stats.peakOpen = std::max(c.stats.peakOpen, openList.size());
+	}
+	//If it is in the open list and it's priority is now lower than it's old amount, lower it in place
+	else if (ng < c.g[n])
+	{
+		c.g[n] = ng;
+		c.parent[n] = u;
+		openList.decreaseKey(n, ng + estimate<H>(n, c.goal));
+		c.stats.decreased++;
+	}
+}
+
+//The A* loop, shared by every open list type, neighborhood N and heuristic H. It picks up where the last call
+//stopped, the open list and the unit data in c are the whole state of the search.
+template<class N, class H, class OpenList>
+bool graph::search(SearchContext &c, OpenList &openList, const SearchLimit &limit) const
+{
+	int i, x, y;
+	Position e = position(c.goal);
+
+	if (!c.opened)
+		openStart<H>(c, openList);
+
+	while (!openList.empty())
+	{
+		int u = openList.top().id;
+		openList.pop();
+
+		c.list[u] = ListStatus::closed;
+		c.stats.popped++;
+		TRACE_EXPANSION(c, u);
+		Position p = position(u);
+		if (limit.partial)
+			keepNearest(c, u, p, e);
+
+		if (u == c.goal)
 		{
 			//We are at the end point so we can clear the open list and end the algorithm.
-			while (!openUnits.empty())
-				openUnits.pop();
+			openList.clear();
 		}
 		else
 		{
-			//Change status of the popped unit unless its the start
-			if (u.status != "S")
-				map[u.pos.x][u.pos.y].status = "P";
+			//Passability of all the units around the popped one in three word reads, off the map reads as blocked
+			unsigned around = passGrid.around(p.x, p.y);
 
 			//Looping thrugh each Unit around the popped one
-			for (i = 0; i < dir; i++)
+			for (i = 0; i < N::count; i++)
 			{
-				x = u.pos.x + dx[i];	//Popped unit position + direction 
-				y = u.pos.y + dy[i];
-
-				if (!(x<0 || x>S - 1 || y<0 || y>S - 1 || //Unit is in the map?
-					map[x][y].closed == true ||	      //Closed?
-					map[x][y].status == "O"))		  //Obstacle?
-				{
-					//Unit we're checking
-					n = map[x][y];
-					n.updateCost(u.g);
-					n.estimatePriority(end.x, end.y);
-
-					//If this unit is not in the open list,add it and update the priority map
-					if (n.open == false)
-					{
-						n.open = true;
-						pMap[x][y] = n.f;
-						openUnits.push(n);
-					}
-					//If it is in the opne list and it's priority is now lower than it's old amount, replace it in the queue
-					else if (pMap[x][y] > n.f)
-					{
-
-						pMap[x][y] = n.f;
-						//move all the q elements to a temperory one
-						openUnits.swap(temp);
-
-						//Move it back to the original q
-						while (!temp.empty())
-						{
-							if (temp.top().pos == n.pos)
-							{
-								openUnits.push(n);
-								temp.pop();
-							}
-							else
-							{
-								openUnits.push(temp.top());
-								temp.pop();
-							}
-
-						}
-
-					}
-				}
+				x = p.x + N::dx(i);	//Popped unit position + direction 
+				y = p.y + N::dy(i);
+
+				if (!((around >> ((N::dy(i) + 1) * 3 + N::dx(i) + 1)) & 1))	//In the map and not an obstacle?
+					continue;
 
+				int n = unitId(x, y);
+				if (c.listStatus(n) == ListStatus::closed)
+					continue;
+
+				//Cost of reaching the unit we're checking through the popped one
+				relax<H>(c, openList, u, n, c.g[u] + moveCost(u, n, N::cost(i)));
 			}
 
 
 		}
+
+		if (!openList.empty() && outOfBudget(c, limit))
+			return false;
 	}
 
+	return true;
+}
 
-	printGraph();
+#pragma endregion
+
+#pragma region Jump Point Search
+
+//Steps from (x, y) in direction (ddx, ddy) until it finds a jump point: the goal, or a unit with a forced neighbor.
+//Returns -1 if it runs into an obstacle or the map edge first.
+int graph::jump(int x, int y, int ddx, int ddy, int goal) const
+{
+	if (ddy == 0)
+		return jumpRow(x, y, ddx, goal);
+
+	while (true)
+	{
+		x += ddx;
+		y += ddy;
+
+		if (!passable(x, y))
+			return -1;
+
+		int id = unitId(x, y);
+		if (id == goal)
+			return id;
+
+		if (ddx != 0 && ddy != 0)
+		{
+			//Diagonal move: an obstacle beside the unit we came from forces a neighbor behind the diagonal
+			if ((passable(x - ddx, y + ddy) && !passable(x - ddx, y)) ||
+				(passable(x + ddx, y - ddy) && !passable(x, y - ddy)))
+				return id;
+
+			//A jump point along either straight part of the move makes this unit one too
+			if (jump(x, y, ddx, 0, goal) != -1 || jump(x, y, 0, ddy, goal) != -1)
+				return id;
+		}
+		else
+		{
+			//Vertical move: an obstacle left or right forces the diagonal past it
+			if ((passable(x + 1, y + ddy) && !passable(x + 1, y)) ||
+				(passable(x - 1, y + ddy) && !passable(x - 1, y)))
+				return id;
+		}
+	}
 }
 
+//Horizontal part of jump, 64 units at a time. A unit ends the jump when it is blocked, is the goal, or has a forced
+//neighbor: an obstacle above or below it with an open unit just past it, which forces the diagonal past the obstacle.
+//Each of those is one mask over the row and the rows beside it, and the first set bit is where the jump ends.
+int graph::jumpRow(int x, int y, int ddx, int goal) const
+{
+	Position g = position(goal);
+	bool goalRow = g.y == y;
+
+	while (true)
+	{
+		uint64_t open, forced, stop;
+
+		if (ddx > 0)
+		{
+			//Units x + 1 to x + 64, the next unit on from each in the shifted reads
+			open = passGrid.bits(x + 1, y);
+			forced = (~passGrid.bits(x + 1, y - 1) & passGrid.bits(x + 2, y - 1)) |
+				(~passGrid.bits(x + 1, y + 1) & passGrid.bits(x + 2, y + 1));
+			stop = ~open | forced;
+			if (goalRow && g.x > x && g.x - x <= 64)
+				stop |= (uint64_t)1 << (g.x - x - 1);
+
+			if (stop)
+			{
+				int t = lowestBit(stop);
+				return ((open >> t) & 1) ? unitId(x + 1 + t, y) : -1;
+			}
+			x += 64;
+		}
+		else
+		{
+			//Units x - 64 to x - 1, scanned from the top bit down
+			open = passGrid.bits(x - 64, y);
+			forced = (~passGrid.bits(x - 64, y - 1) & passGrid.bits(x - 65, y - 1)) |
+				(~passGrid.bits(x - 64, y + 1) & passGrid.bits(x - 65, y + 1));
+			stop = ~open | forced;
+			if (goalRow && g.x < x && x - g.x <= 64)
+				stop |= (uint64_t)1 << (g.x - x + 64);
+
+			if (stop)
+			{
+				int t = highestBit(stop);
+				return ((open >> t) & 1) ? unitId(x - 64 + t, y) : -1;
+			}
+			x -= 64;
+		}
+	}
+}
+
+//Fills ddx/ddy with the directions worth jumping in from unit u and returns how many there are.
+//Neighbors that the parent reaches at least as cheaply without going through u are pruned.
+int graph::jumpDirections(const SearchContext &c, int u, int *ddx, int *ddy) const
+{
+	int count = 0;
+
+	if (c.parent[u] == -1)
+	{
+		//The start has no parent, so every direction is open
+		for (int i = 0; i < dir; i++)
+		{
+			ddx[count] = dx[i];
+			ddy[count++] = dy[i];
+		}
+		return count;
+	}
+
+	Position p = position(u);
+	Position from = position(c.parent[u]);
+	int mx = (p.x > from.x) - (p.x < from.x);
+	int my = (p.y > from.y) - (p.y < from.y);
+
+	if (mx != 0 && my != 0)
+	{
+		//Natural neighbors of a diagonal move
+		ddx[count] = mx; ddy[count++] = 0;
+		ddx[count] = 0; ddy[count++] = my;
+		ddx[count] = mx; ddy[count++] = my;
+
+		//Forced neighbors
+		if (!passable(p.x - mx, p.y))
+		{
+			ddx[count] = -mx; ddy[count++] = my;
+		}
+		if (!passable(p.x, p.y - my))
+		{
+			ddx[count] = mx; ddy[count++] = -my;
+		}
+	}
+	else if (mx != 0)
+	{
+		ddx[count] = mx; ddy[count++] = 0;
+
+		if (!passable(p.x, p.y + 1))
+		{
+			ddx[count] = mx; ddy[count++] = 1;
+		}
+		if (!passable(p.x, p.y - 1))
+		{
+			ddx[count] = mx; ddy[count++] = -1;
+		}
+	}
+	else
+	{
+		ddx[count] = 0; ddy[count++] = my;
+
+		if (!passable(p.x + 1, p.y))
+		{
+			ddx[count] = 1; ddy[count++] = my;
+		}
+		if (!passable(p.x - 1, p.y))
+		{
+			ddx[count] = -1; ddy[count++] = my;
+		}
+	}
+
+	return count;
+}
+
+//A* over jump points only. Successors are found by jump(), or read from the jump table for jumpPointPlus,
+//so units in between are never put in the open list.
+template<class H, class OpenList>
+bool graph::jumpSearch(SearchContext &c, OpenList &openList, const SearchLimit &limit) const
+{
+	int ddx[dir], ddy[dir];
+	const JumpTable *table = (searchMode == SearchMode::jumpPointPlus && jumpTable && jumpTable->usable()) ? jumpTable : nullptr;
+	Position e = position(c.goal);
+
+	if (!c.opened)
+		openStart<H>(c, openList);
+
+	while (!openList.empty())
+	{
+		int u = openList.top().id;
+		openList.pop();
+
+		c.list[u] = ListStatus::closed;
+		c.stats.popped++;
+		TRACE_EXPANSION(c, u);
+		Position p = position(u);
+		if (limit.partial)
+			keepNearest(c, u, p, e);
+
+		if (u == c.goal)
+		{
+			openList.clear();
+			break;
+		}
+
+		int count = jumpDirections(c, u, ddx, ddy);
+		for (int i = 0; i < count; i++)
+		{
+			int n = table ? table->jump(p.x, p.y, ddx[i], ddy[i], c.goal) : jump(p.x, p.y, ddx[i], ddy[i], c.goal);
+			if (n == -1 || c.listStatus(n) == ListStatus::closed)
+				continue;
+
+			//Jumps follow a straight line or a diagonal over units of one weight, so the cost is the step count times the step cost
+			Position q = position(n);
+			int steps = std::max(abs(q.x - p.x), abs(q.y - p.y));
+			float step = (ddx[i] != 0 && ddy[i] != 0) ? DIAGONAL_COST : STRAIGHT_COST;
+
+			relax<H>(c, openList, u, n, c.g[u] + steps * step * minWeight);
+		}
+
+		if (!openList.empty() && outOfBudget(c, limit))
+			return false;
+	}
+
+	return true;
+}
+
+#pragma endregion
+
+#pragma region Search Context
+
+//Sizes the search data for a map of unitCount units. Does nothing if it already fits.
+void SearchContext::resize(int unitCount)
+{
+	if ((int)stamp.size() == unitCount)
+		return;
+
+	stamp.assign(unitCount, 0);
+	list.assign(unitCount, ListStatus::none);
+	g.assign(unitCount, 0);
+	parent.assign(unitCount, -1);
+	openHeap.resize(unitCount);
+	openBuckets.resize(unitCount);
+	generation = 0;
+}
+
+//Invalidates the data of the previous search
+void SearchContext::newSearch()
+{
+	generation++;
+	stats = SearchStats();
+	opened = false;
+#ifdef PATH_TRACE
+	trace.clear();
+#endif
+
+	//Once every 4 billion searches the counter wraps and old stamps could match again
+	if (generation == 0)
+	{
+		std::fill(stamp.begin(), stamp.end(), 0);
+		generation = 1;
+	}
+}
+
+#pragma endregion
+
 //Constructor
-graph::graph()
+graph::graph(int width, int height) : w(width), h(height)
 {
-	initMap(S*3);
+	initMap(w*3);
 }
 #pragma region Helper Methods
 int graph::randIndex()
 {
-	return rand() % S;
+	return rand() % w;
+}
+
+
+//Octile distance at weight 1, used by the layers built on the graph. It ignores the weights on the map,
+//so it stays a lower bound through any edit and layers that keep estimates between edits can rely on it.
+float graph::estimate(int id, int goal) const
+{
+	Position p = position(id);
+	Position e = position(goal);
+
+	return OctileHeuristic::estimate(abs(e.x - p.x), abs(e.y - p.y));
 }
 
+//Checks the units the line crosses a row at a time. Within a row they form one run, tested as a whole with
+//PassGrid::rowOpen. A line through the corner where units meet counts as crossing all of them.
+bool graph::lineOfSight(Position a, Position b) const
+{
+	if (a.y > b.y)
+		std::swap(a, b);
+
+	if (a.y == b.y)
+		return passGrid.rowOpen(a.y, std::min(a.x, b.x), std::max(a.x, b.x));
+
+	double slope = (double)(b.x - a.x) / (b.y - a.y);
+	int lo = std::min(a.x, b.x), hi = std::max(a.x, b.x);
+
+	for (int y = a.y; y <= b.y; y++)
+	{
+		//Where the line enters and leaves the row, both within the segment
+		double x0 = a.x + slope * (std::max(y - 0.5, (double)a.y) - a.y);
+		double x1 = a.x + slope * (std::min(y + 0.5, (double)b.y) - a.y);
+		if (x0 > x1)
+			std::swap(x0, x1);
+
+		int first = std::max(lo, (int)std::floor(x0 + 0.5 - 1e-9));
+		int last = std::min(hi, (int)std::floor(x1 + 0.5 + 1e-9));
+		if (!passGrid.rowOpen(y, first, last))
+			return false;
+	}
+
+	return true;
+}
+
+//Changes the map and tells every listener, so layers built on the graph stay in step with it
+void graph::setStatus(int x, int y, UnitStatus s)
+{
+	if (getStatus(x, y) == s)
+		return;
+
+	passGrid.set(x, y, s != UnitStatus::obstacle);
+
+	for (MapListener *l : listeners)
+		l->unitChanged(x, y);
+}
+
+void graph::setWeight(int x, int y, uint8_t wt)
+{
+	int id = unitId(x, y);
+	wt = std::max<uint8_t>(wt, 1);
+	if (weight[id] == wt)
+		return;
+
+	weightCount[weight[id]]--;
+	weightCount[wt]++;
+	weight[id] = wt;
+
+	while (weightCount[minWeight] == 0 && minWeight < wt)
+		minWeight++;
+	while (weightCount[maxWeight] == 0 && maxWeight > wt)
+		maxWeight--;
+	minWeight = std::min<int>(minWeight, wt);
+	maxWeight = std::max<int>(maxWeight, wt);
+
+	for (MapListener *l : listeners)
+		l->unitChanged(x, y);
+}
+
+void graph::addListener(MapListener *l)
+{
+	listeners.push_back(l);
+}
+
+void graph::removeListener(MapListener *l)
+{
+	listeners.erase(std::remove(listeners.begin(), listeners.end(), l), listeners.end());
+}
+
+float graph::cost(int x, int y) const
+{
+	return cost(context, x, y);
+}
+
+float graph::cost(const SearchContext &c, int x, int y) const
+{
+	int id = unitId(x, y);
+	if (c.listStatus(id) == ListStatus::none)
+		return std::numeric_limits<float>::infinity();
+	return c.g[id];
+}
 
 float graph::calcDist(Position p1, Position p2)
 {
@@ -169,15 +725,34 @@ float graph::calcDist(Position p1, Position p2)
 //Print graph out
 void graph::printGraph()
 {
-	for (int i = 0; i < S; i++)
+	for (int i = 0; i < w; i++)
 	{
-		for (int j = 0; j < S; j++)
+		for (int j = 0; j < h; j++)
 		{
-			std::cout << map[i][j].status << " ";
+			char c = (char)getStatus(i, j);
+
+			if (start == Position{ i, j })
+				c = 'S';
+			else if (end == Position{ i, j })
+				c = 'F';
+			else if (context.listStatus(unitId(i, j)) == ListStatus::closed)
+				c = 'P';	//Expanded by the last search
+
+			std::cout << c << " ";
 		}
 		std::cout << "\n";
 	}
 }
+
+//Print what the last search did
+void graph::printStats()
+{
+	const SearchStats &s = context.stats;
+
+	std::cout << "popped " << s.popped << ", pushed " << s.pushed << ", decrease-key " << s.decreased
+		<< ", peak open " << s.peakOpen << "\n";
+	std::cout << "path " << s.pathLength << " units, cost " << s.pathCost << ", " << s.milliseconds << " ms\n";
+}
 #pragma endregion
 
 
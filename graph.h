@@ -36,18 +36,22 @@ C++ demonstration of the A* pathfinding algorithm
 #include <iostream>
 #include <vector>
 #include <string>
-
-const int S = 16; //Length of a map side
-
-const int dir = 8; //Number of possible directions we can move
-
-//4 directions
-//static int dx[dir]={1, 0, -1, 0};
-//static int dy[dir]={0, 1, 0, -1};
-
-//8 directions
-static int dx[dir] = { 1, 1, 0, -1, -1, -1, 0, 1 };
-static int dy[dir] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+#include <chrono>
+
+#include "OpenList.h"
+#include "SearchPolicies.h"
+#include "PassGrid.h"
+
+//Selects the algorithm graph::findPath uses
+enum class SearchMode {
+	aStar,
+	jumpPoint,	//Jump Point Search, same path costs as aStar with far fewer open list operations. 8 neighbors only.
+	jumpPointPlus	//JPS with jumps read from graph::jumpTable, the same paths as jumpPoint. Falls back to it without a table.
+};
 
 //Struct to hold a x and y value(like a 2d vector)
 struct Position {
@@ -63,72 +67,209 @@ static bool operator==(const Position &A, const Position &B)
 	return (A.x == B.x && B.y == A.y);
 }
 
-//struct for a basic unit in a grid based map
-struct Unit {
-	Position pos;
-
-
-	//A* data
-	std::string status = "";
-	bool open = false;
-	bool closed = false;
-	float f=0; //total estimated cost (prioritry, lower=better)
-	float g=0; //cost so far
-	float h=0; //estimate cost from this unit to the end (main heuristic)
-
-	void estimatePriority(int xf, int yf)
-	{
-		int xd, yd;
-		
-		xd = xf - pos.x;
-		yd = yf - pos.y;
-
-		h = sqrt(xd*xd + yd*yd);
-
-		//h=abs(xd)+abs(yd);
-
-		//h=std::max(abs(xd), abs(yd));
-		//Estimated cost = cost so fa
-		f = g + h * 10;
-	}
-
-	//Updating the unit's value of g (cost to get to this unit)
-	void updateCost(float _g)
-	{
-		g = _g + 10;
-		
-	}
+//Status of a unit on the map, stored as one bit per unit in graph's PassGrid. The values are the characters printGraph shows.
+//Search progress is kept apart from it so the map stays clean between queries.
+enum class UnitStatus : uint8_t {
+	empty = '.',
+	obstacle = 'O'
 };
 
+//Whether the current search has put a unit in the open or closed list
+enum class ListStatus : uint8_t {
+	none,
+	open,
+	closed
+};
 
+//What one search did, filled in by every findPath
+struct SearchStats {
+	int popped = 0; //Units taken off the open list
+	int pushed = 0; //Units put on the open list
+	int decreased = 0; //Decrease-key calls, a unit reached again more cheaply while still open
+	int peakOpen = 0; //Most units in the open list at once
+	int pathLength = 0; //Units on the path, start and end included. 0 when the end wasn't reached.
+	float pathCost = std::numeric_limits<float>::infinity();
+	double milliseconds = 0; //Wall time of the whole findPath
+};
 
-static bool operator<(const Unit &A, const Unit &B)
-{
-	return A.f > B.f; 
-}
+//Progress of a search run a piece at a time with graph::continuePath
+enum class SearchStatus {
+	running,	//The budget ran out first, call continuePath again
+	found,
+	unreachable
+};
+
+//How much one continuePath call may do, no limit by default. At least one unit is expanded per call.
+struct SearchBudget {
+	int expansions = std::numeric_limits<int>::max();
+	double microseconds = std::numeric_limits<double>::infinity();
+};
+
+//Build with PATH_TRACE defined to have every search record the order it expanded units in.
+//Without it the trace isn't even a member, so normal builds pay nothing for it.
+#ifdef PATH_TRACE
+#define TRACE_EXPANSION(c, u) (c).trace.push_back(u)
+#else
+#define TRACE_EXPANSION(c, u) ((void)0)
+#endif
+
+//Everything a search writes while it runs. The map itself is only read, so any number of
+//searches can run on one graph at the same time as long as each has its own context.
+struct SearchContext {
+
+	//Search data, indexed like the map. list, g and parent only hold values for the search whose generation
+	//matches the stamp, so starting a new search is a single increment of generation instead of a sweep.
+	std::vector<uint32_t> stamp;
+	std::vector<ListStatus> list;
+	std::vector<float> g; //cost so far
+	std::vector<int> parent; //unit we came from, -1 for none
+	uint32_t generation = 0;
+
+	RebuildQueue openUnits; //The original priority queue open list
+	IndexedHeap openHeap; //Open list with O(log n) decrease-key
+	BucketQueue openBuckets; //Open list with a bucket per whole f value
+
+	int start = -1; //Unit ids of the current query
+	int goal = -1;
+	//Unit ids of the route, start first. Empty when the goal can't be reached. While a search run with
+	//continuePath is still going, the route so far: from the start to nearest.
+	std::vector<int> path;
+	SearchStats stats; //Of the last search
+	SearchStatus status = SearchStatus::unreachable;
+	bool opened = false; //Whether the current search has put the start in the open list yet
+	int nearest = -1; //Expanded unit closest to the goal by octile distance, where a partial route ends.
+	                  //Only kept by continuePath calls with a budget, a search run to the end never reads it.
+	float nearestDistance = 0;
+#ifdef PATH_TRACE
+	std::vector<int> trace; //Unit ids in the order the last search expanded them
+#endif
+
+	void resize(int unitCount);
+	void newSearch();
+	ListStatus listStatus(int id) const { return stamp[id] == generation ? list[id] : ListStatus::none; }
+};
+
+class Landmarks;
+class JumpTable;
+
+//Implemented by anything that keeps data worked out from a graph's map, so it hears about every edit
+class MapListener {
+public:
+	virtual ~MapListener() {}
+	virtual void unitChanged(int x, int y) = 0; //Called after the status or the weight of (x, y) changed
+};
 
 class graph {
-	
-	std::priority_queue<Unit> openUnits; //We use a priority queue for the open list.
-	
 
-	int pMap[S][S]; //Map of unit priorities(value of f)
+	int w, h; //Map size in units
+
+	//Unit data, stored as one dense array per field and indexed row by row (y * w + x)
+	PassGrid passGrid; //Bit set when the unit isn't an obstacle
+	std::vector<uint8_t> weight; //Terrain cost of each unit, 1 for plain ground. A byte each so large maps stay small.
+
+	int weightCount[256]; //Units of each weight, so the lowest and highest are known without a sweep
+	int minWeight = 1;
+	int maxWeight = 1;
+
+	SearchContext context; //Used by the single-threaded findPath
+
+	std::vector<MapListener*> listeners;
+
+	//Where the current continuePath call has to stop
+	struct SearchLimit {
+		int popped; //Total units expanded by the search
+		bool timed;
+		std::chrono::steady_clock::time_point deadline;
+		bool partial; //Whether the limit can stop the search, only then is nearest kept
+	};
+	static bool outOfBudget(const SearchContext &c, const SearchLimit &limit);
+
+	//The search loops return true when the search is over, false when the limit stopped them first
+	template<class OpenList>
+	bool runSearch(SearchContext &c, OpenList &openList, const SearchLimit &limit) const;
+	template<class H, class OpenList>
+	bool runSearch(SearchContext &c, OpenList &openList, const SearchLimit &limit) const;
+
+	template<class H>
+	float estimate(int id, int goal) const;
+	template<class H, class OpenList>
+	void openStart(SearchContext &c, OpenList &openList) const;
+	template<class H, class OpenList>
+	void relax(SearchContext &c, OpenList &openList, int u, int n, float ng) const;
+	template<class N, class H, class OpenList>
+	bool search(SearchContext &c, OpenList &openList, const SearchLimit &limit) const;
+
+	int jump(int x, int y, int ddx, int ddy, int goal) const;
+	int jumpRow(int x, int y, int ddx, int goal) const;
+	int jumpDirections(const SearchContext &c, int u, int *ddx, int *ddy) const;
+	template<class H, class OpenList>
+	bool jumpSearch(SearchContext &c, OpenList &openList, const SearchLimit &limit) const;
+
+	void buildPath(SearchContext &c, int end) const;
 
 	void initMap(int oCount);
 
 	void printGraph();
+	void printStats();
 	int randIndex();
 	float calcDist(Position p1, Position p2);
 
 public:
-	Unit map[S][S];
 	Position start;
 	Position end;
-	std::vector<Unit> path;
+	std::vector<int> path; //Unit ids of the route found by the last findPath(from, to)
+	OpenListMode openListMode = OpenListMode::indexedHeap; //Which open list aStarPF uses
+	SearchMode searchMode = SearchMode::aStar;
+	Neighborhood neighborhood = Neighborhood::eight;
+	Heuristic heuristic = Heuristic::octile;
+	const Landmarks *landmarks = nullptr; //Table for Heuristic::landmarks
+	const JumpTable *jumpTable = nullptr; //Table for SearchMode::jumpPointPlus
 	void aStarPF();
-	graph();
+	bool findPath(Position from, Position to);
+	bool findPath(SearchContext &c, Position from, Position to) const;
+
+	//The same search a piece at a time, so a long query can be spread over several frames. startPath sets it up,
+	//then each continuePath expands units until the search ends or the budget runs out. c keeps the search
+	//in between, and its path holds the best partial route so far. The map and the settings must not change
+	//until the search ends, start it again after an edit.
+	void startPath(SearchContext &c, Position from, Position to) const;
+	SearchStatus continuePath(SearchContext &c, const SearchBudget &budget) const;
+	void startPath(Position from, Position to); //With the graph's own context, continuePath copies the route to path
+	SearchStatus continuePath(const SearchBudget &budget);
+
+	int width() const { return w; }
+	int height() const { return h; }
+	int unitId(int x, int y) const { return y * w + x; }
+	Position position(int id) const { return { id % w, id / w }; }
+	bool passable(int x, int y) const { return x >= 0 && x < w && y >= 0 && y < h && passGrid.get(x, y); }
+	const PassGrid &grid() const { return passGrid; }
+	bool lineOfSight(Position a, Position b) const; //Whether the straight line between the centers of two units on the map only crosses passable units
+	float estimate(int id, int goal) const; //octile estimate from a unit to the goal, whatever heuristic findPath uses
+	uint8_t getWeight(int x, int y) const { return weight[unitId(x, y)]; }
+	void setWeight(int x, int y, uint8_t w); //Terrain cost of a unit, from 1 (plain ground) to 255
+	int lowestWeight() const { return minWeight; }
+	bool uniformWeights() const { return minWeight == maxWeight; }
+	//Cost of a move of the given length (STRAIGHT_COST or DIAGONAL_COST) between neighbors a and b. Each half of the move is
+	//paid at the weight of the unit it crosses, so moves cost the same both ways and stay whole numbers.
+	float moveCost(int a, int b, float length) const { return length * (weight[a] + weight[b]) * 0.5f; }
+	UnitStatus getStatus(int x, int y) const { return passGrid.get(x, y) ? UnitStatus::empty : UnitStatus::obstacle; }
+	void setStatus(int x, int y, UnitStatus s);
+	void setObstacle(int x, int y) { setStatus(x, y, UnitStatus::obstacle); }
+	void clearObstacle(int x, int y) { setStatus(x, y, UnitStatus::empty); }
+
+	void addListener(MapListener *l);
+	void removeListener(MapListener *l);
+	float cost(int x, int y) const; //cost of the last findPath(from, to) to reach a unit, infinity if it never did
+	float cost(const SearchContext &c, int x, int y) const;
+	const SearchStats &stats() const { return context.stats; } //of the last findPath(from, to)
+
+	graph(int width, int height);
 	
 };
 
+//Reads the landmark table instead of the distances, defined in graph.cpp
+template<>
+float graph::estimate<LandmarkHeuristic>(int id, int goal) const;
+
 
 #endif GRAPH_H
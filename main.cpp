@@ -23,24 +23,36 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 Description:
 
 C++ demonstration of the A* algorithm
+
+Command line: [width [height]]. The map is 16 x 16 by default, and square when only the width is given.
 */
 
 
+#include <cstdlib>
+
 #include "GLRender.h"
 #include "GameObject.h"
 #include "graph.h"
+#include "PathService.h"
 
 
 #pragma region program specific Data members
 
 float timestep = .016;
 
+const int defaultSide = 16; //Length of a map side when none is given on the command line
+const int maxSide = 400; //Larger maps would draw units less than 2 pixels wide in the 800 pixel window
+int mapWidth = defaultSide;
+int mapHeight = defaultSide;
+float unitSize = 1.0f / defaultSide; //Half the on-screen size of a unit, so the larger side fills the window
+
 enum State{start,end,obstacle,pathing};
 
 State current = start;
 glm::vec3 mousePos;
 int obscount = 0;
 graph *g;
+PathService *paths; //Searches on worker threads, answers are picked up once per frame
 
 Model* baseMesh;
 Model* pathMesh;
@@ -49,7 +61,15 @@ Model* pointMesh;
 // vector of scene bodies
 std::vector<GameObject*> bodies;
 
-GameObject *goMap[S][S];
+std::vector<GameObject*> goMap; //One square per unit, indexed like the graph (y * mapWidth + x)
+
+int pathTicket = 0; //Request for the route being waited for, 0 for none
+std::vector<int> shownPath; //Units painted with pathMesh
+
+GameObject *&goUnit(int x, int y)
+{
+	return goMap[y * mapWidth + x];
+}
 
 #pragma endregion
 
@@ -75,12 +95,12 @@ glm::vec3 GetMousePos()
 glm::vec2 getUnit(glm::vec3 mPos)
 {
 	
-	for (int i = 0; i < S; i++)
+	for (int i = 0; i < mapWidth; i++)
 	{
 
-		for (int j = 0; j < S; j++)
+		for (int j = 0; j < mapHeight; j++)
 		{
-			if (glm::distance(mPos, goMap[i][j]->Position()) < 1.0f / S)
+			if (glm::distance(mPos, goUnit(i, j)->Position()) < unitSize)
 			{
 				return glm::vec2(i, j);
 			}	
@@ -100,7 +120,7 @@ void changeColor(glm::vec2 pos)
 	{
 		g->start.x = pos.x;
 		g->start.y = pos.y;
-		goMap[g->start.x][g->start.y]->setModel(pointMesh);
+		goUnit(g->start.x, g->start.y)->setModel(pointMesh);
 		
 
 		current = end;
@@ -109,7 +129,7 @@ void changeColor(glm::vec2 pos)
 	{
 		g->end.x = pos.x;
 		g->end.y = pos.y;
-		goMap[g->end.x][g->end.y]->setModel(pointMesh);
+		goUnit(g->end.x, g->end.y)->setModel(pointMesh);
 
 		current = obstacle;
 
@@ -117,27 +137,66 @@ void changeColor(glm::vec2 pos)
 	}
 	else if (current == obstacle)
 	{
-		g->map[(int)pos.x][(int)pos.y].status = "O";
-		goMap[(int)pos.x][(int)pos.y]->setModel(obsMesh);
+		g->setObstacle(pos.x, pos.y);
+		goUnit(pos.x, pos.y)->setModel(obsMesh);
 
 		obscount++;
 
-		if (obscount > S*2)
+		if (obscount > mapWidth * 2)
 		{
 			current = pathing;
 
-			g->aStarPF();
-
-			for (Unit u : g->path)
-			{
-				goMap[u.pos.x][u.pos.y]->setModel(pathMesh);
-			}
+			//The search runs on a worker thread instead of in this callback, a newer request replaces an older one
+			if (pathTicket != 0)
+				paths->cancel(pathTicket);
+			pathTicket = paths->request(g->start, g->end);
 		}
 		else
-			std::cout << S * 2 - obscount << " obstacles left.\n";
+			std::cout << mapWidth * 2 - obscount << " obstacles left.\n";
 	}
 }
 
+//Paints units with pathMesh, putting back the ones painted last time
+void showPath(const std::vector<int> &units)
+{
+	//The start and end keep their markers, the route is only painted between them
+	for (int id : shownPath)
+	{
+		Position p = g->position(id);
+		if (p == g->start || p == g->end)
+			goUnit(p.x, p.y)->setModel(pointMesh);
+		else
+			goUnit(p.x, p.y)->setModel(g->passable(p.x, p.y) ? baseMesh : obsMesh);
+	}
+
+	for (int id : units)
+	{
+		Position p = g->position(id);
+		if (!(p == g->start || p == g->end))
+			goUnit(p.x, p.y)->setModel(pathMesh);
+	}
+
+	shownPath = units;
+}
+
+//Picks up the answers that came in since the last frame without waiting for any search
+void receivePaths()
+{
+	paths->drain([](int ticket, PathResult &result)
+	{
+		if (ticket != pathTicket)
+			return;
+
+		pathTicket = 0;
+		showPath(result.path);
+
+		if (result.found)
+			std::cout << "Path found, cost " << result.cost << ".\n";
+		else
+			std::cout << "The end can't be reached.\n";
+	});
+}
+
 void update()
 {
 
@@ -223,8 +282,18 @@ Model* setupModel(int n, glm::vec4 color, float size = 0.25f)
 
 
 
-void main()
+int main(int argc, char **argv)
 {
+	if (argc > 1)
+		mapWidth = mapHeight = atoi(argv[1]);
+	if (argc > 2)
+		mapHeight = atoi(argv[2]);
+	if (argc > 3 || mapWidth < 2 || mapHeight < 2 || mapWidth > maxSide || mapHeight > maxSide)
+	{
+		std::cerr << "usage: " << argv[0] << " [width [height]], each from 2 to " << maxSide << "\n";
+		return 2;
+	}
+
 	// Initializes most things needed before the main loop
 	init();
 	
@@ -233,34 +302,37 @@ void main()
 	glfwSetMouseButtonCallback(window, mouse_button_callback);
 
 
-	g = new graph();
+	g = new graph(mapWidth, mapHeight);
+	paths = new PathService(*g);
+	unitSize = 1.0f / std::max(mapWidth, mapHeight);
+	goMap.resize(mapWidth * mapHeight);
 
 	//Creating differently colored squares for the grid
-	baseMesh = setupModel(4, glm::vec4(0.2, 0.4,0.4, 1),1.0f / S);
-	obsMesh= setupModel(4, glm::vec4(0.8, 0, 0, 1), 1.0f / S);
-	pathMesh = setupModel(4, glm::vec4(0, 1, 0, 1), 1.0f / S);
-	pointMesh = setupModel(4, glm::vec4(0, 0, 0, 1), 1.0f / S);
+	baseMesh = setupModel(4, glm::vec4(0.2, 0.4,0.4, 1), unitSize);
+	obsMesh= setupModel(4, glm::vec4(0.8, 0, 0, 1), unitSize);
+	pathMesh = setupModel(4, glm::vec4(0, 1, 0, 1), unitSize);
+	pointMesh = setupModel(4, glm::vec4(0, 0, 0, 1), unitSize);
 
 	//Creating grid elements and placing them on screen
-	float x = -1 + 1.0f / S;
-	float y = 1 - 1.0f / S;
+	float x = -1 + unitSize;
+	float y = 1 - unitSize;
 
-	for (int i = 0; i < S; i++)
+	for (int i = 0; i < mapWidth; i++)
 	{
-		for (int j = 0; j < S; j++)
+		for (int j = 0; j < mapHeight; j++)
 		{
-			goMap[i][j] = new GameObject(baseMesh);
-			goMap[i][j]->setRotation(glm::vec3(0, 0, PI / 4));
+			goUnit(i, j) = new GameObject(baseMesh);
+			goUnit(i, j)->setRotation(glm::vec3(0, 0, PI / 4));
 
-			goMap[i][j]->Position(glm::vec3(x,y, 0));
+			goUnit(i, j)->Position(glm::vec3(x,y, 0));
 
-			y -= 2.0f / S;
+			y -= 2.0f * unitSize;
 
-			bodies.push_back(goMap[i][j]);
+			bodies.push_back(goUnit(i, j));
 		}
 
-		y = 1 - 1.0f / S;
-		x += 2.0f / S;
+		y = 1 - unitSize;
+		x += 2.0f * unitSize;
 
 	}
 
@@ -271,6 +343,8 @@ void main()
 	// Enter the main loop.
 	while (!glfwWindowShouldClose(window))
 	{
+		receivePaths();
+
 		// Call to update() which will update the gameobjects.
 		update();
 
@@ -292,9 +366,10 @@ void main()
 	for (GameObject *body : bodies)
 		delete body;
 
+	delete paths;
 	delete g;
 	//Cleans shaders and the program and frees up GLFW memory
 	cleanup();
 
-	return;
+	return 0;
 }
\ No newline at end of file
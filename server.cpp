@@ -0,0 +1,545 @@
+/*
+File Name : server.cpp
+Copyright  2018
+Original authors : Sanketh Bhat
+Written under the supervision of David I.Schwartz, Ph.D., and
+supported by a professional development seed grant from the B.Thomas
+Golisano College of Computing & Information Sciences
+(https ://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software : you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.If not, see <http://www.gnu.org/licenses/>.
+
+
+Description:
+Headless query server. Reads one command per line from stdin, or from the clients of a Unix socket
+with --socket <path>, and writes one reply line per command. No window, display or GPU is needed.
+Socket clients are served side by side, each command runs whole before the next one from any client.
+A socket client that sends a line over 4096 bytes is dropped, and one that doesn't read its replies
+stops being read itself once 1 MB of them are waiting.
+
+Commands:
+	size w h					new empty map
+	load file					MovingAI .map file
+	block x y / clear x y		obstacle edits
+	weight x y w				terrain cost of a unit, 1 to 255
+	set mode astar|jps|jps+, set open rebuild|heap|bucket, set heuristic octile|manhattan|euclidean|none|landmarks,
+	set neighbors 4|8
+	landmarks build k / landmarks load file / landmarks save file
+	path sx sy gx gy			replies "path cost units x0 y0 x1 y1 ..." or "none"
+	stats						counters of the last path
+	quit
+Every other reply is "ok" or "error <reason>".
+*/
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "graph.h"
+#include "Landmarks.h"
+#include "MovingAI.h"
+#include "JumpTable.h"
+
+//Map and settings shared by every client, so edits made by one are seen by the next
+struct ServerState {
+	std::unique_ptr<graph> map;
+	std::unique_ptr<Landmarks> landmarks;
+	std::unique_ptr<JumpTable> jumpTable; //Built the first time jps+ is selected, then kept up to date by the edits
+	SearchContext context;
+};
+
+//Reads one line without its end of line. Returns false at the end of the input.
+static bool readLine(FILE *in, std::string &line)
+{
+	line.clear();
+
+	int c;
+	while ((c = getc(in)) != EOF && c != '\n')
+		line += (char)c;
+
+	if (!line.empty() && line.back() == '\r')
+		line.pop_back();
+
+	return c != EOF || !line.empty();
+}
+
+//Settings are kept on the graph, a new map starts with the defaults
+static bool applySetting(graph &map, const std::string &name, const std::string &value)
+{
+	if (name == "mode" && value == "astar")
+		map.searchMode = SearchMode::aStar;
+	else if (name == "mode" && value == "jps")
+		map.searchMode = SearchMode::jumpPoint;
+	else if (name == "mode" && value == "jps+")
+		map.searchMode = SearchMode::jumpPointPlus;
+	else if (name == "open" && value == "rebuild")
+		map.openListMode = OpenListMode::rebuild;
+	else if (name == "open" && value == "heap")
+		map.openListMode = OpenListMode::indexedHeap;
+	else if (name == "open" && value == "bucket")
+		map.openListMode = OpenListMode::bucket;
+	else if (name == "heuristic" && value == "octile")
+		map.heuristic = Heuristic::octile;
+	else if (name == "heuristic" && value == "manhattan")
+		map.heuristic = Heuristic::manhattan;
+	else if (name == "heuristic" && value == "euclidean")
+		map.heuristic = Heuristic::euclidean;
+	else if (name == "heuristic" && value == "none")
+		map.heuristic = Heuristic::none;
+	else if (name == "heuristic" && value == "landmarks")
+		map.heuristic = Heuristic::landmarks;
+	else if (name == "neighbors" && value == "4")
+		map.neighborhood = Neighborhood::four;
+	else if (name == "neighbors" && value == "8")
+		map.neighborhood = Neighborhood::eight;
+	else
+		return false;
+
+	return true;
+}
+
+//A new map drops the tables of the old one, they listen to that graph
+static void replaceMap(ServerState &state, graph *map)
+{
+	state.landmarks.reset();
+	state.jumpTable.reset();
+	state.map.reset(map);
+}
+
+//Appends printf style text to a reply
+static void appendReply(std::string &out, const char *format, ...)
+{
+	char buffer[256];
+	va_list args;
+	va_start(args, format);
+	int n = vsnprintf(buffer, sizeof(buffer), format, args);
+	va_end(args);
+
+	if (n < (int)sizeof(buffer))
+	{
+		out.append(buffer, std::max(n, 0));
+		return;
+	}
+
+	//Only error replies that echo a long word get here
+	std::vector<char> big(n + 1);
+	va_start(args, format);
+	vsnprintf(big.data(), big.size(), format, args);
+	va_end(args);
+	out.append(big.data(), n);
+}
+
+//Runs one command and appends its reply to out. Returns false on quit.
+static bool command(ServerState &state, const std::string &line, std::string &out)
+{
+	std::istringstream in(line);
+	std::string word;
+
+	if (!(in >> word))
+		return true;
+
+	graph *map = state.map.get();
+	bool inside = false;
+	int x, y, gx, gy;
+
+	if (word == "quit")
+		return false;
+
+	if (word == "size")
+	{
+		if (in >> x >> y && x > 0 && y > 0)
+		{
+			replaceMap(state, new graph(x, y));
+			appendReply(out, "ok\n");
+		}
+		else
+			appendReply(out, "error size needs a width and a height\n");
+	}
+	else if (word == "load")
+	{
+		std::string file;
+		std::unique_ptr<graph> loaded;
+		if (in >> file)
+			loaded = loadMovingAIMap(file.c_str());
+
+		if (loaded)
+		{
+			replaceMap(state, loaded.release());
+			appendReply(out, "ok\n");
+		}
+		else
+			appendReply(out, "error can't load map\n");
+	}
+	else if (!map)
+		appendReply(out, "error no map, send size or load first\n");
+	else if (word == "block" || word == "clear")
+	{
+		inside = in >> x >> y && x >= 0 && x < map->width() && y >= 0 && y < map->height();
+		if (!inside)
+			appendReply(out, "error unit outside the map\n");
+		else
+		{
+			if (word == "block")
+				map->setObstacle(x, y);
+			else
+				map->clearObstacle(x, y);
+			appendReply(out, "ok\n");
+		}
+	}
+	else if (word == "weight")
+	{
+		int wt = 0;
+		inside = in >> x >> y >> wt && x >= 0 && x < map->width() && y >= 0 && y < map->height();
+		if (!inside)
+			appendReply(out, "error unit outside the map\n");
+		else if (wt < 1 || wt > 255)
+			appendReply(out, "error weight must be 1 to 255\n");
+		else
+		{
+			map->setWeight(x, y, (uint8_t)wt);
+			appendReply(out, "ok\n");
+		}
+	}
+	else if (word == "set")
+	{
+		std::string name, value;
+		in >> name >> value;
+		if (applySetting(*map, name, value))
+		{
+			if (map->searchMode == SearchMode::jumpPointPlus && !state.jumpTable)
+			{
+				state.jumpTable.reset(new JumpTable(*map));
+				state.jumpTable->build();
+				map->jumpTable = state.jumpTable.get();
+			}
+			appendReply(out, "ok\n");
+		}
+		else
+			appendReply(out, "error unknown setting\n");
+	}
+	else if (word == "landmarks")
+	{
+		std::string action, arg;
+		in >> action >> arg;
+		if (!state.landmarks)
+			state.landmarks.reset(new Landmarks(*map));
+
+		bool ok = false;
+		if (action == "build" && atoi(arg.c_str()) > 0)
+		{
+			state.landmarks->build(atoi(arg.c_str()));
+			ok = true;
+		}
+		else if (action == "load")
+			ok = state.landmarks->load(arg.c_str());
+		else if (action == "save")
+			ok = state.landmarks->save(arg.c_str());
+
+		map->landmarks = state.landmarks.get();
+		if (ok)
+			appendReply(out, "ok\n");
+		else
+			appendReply(out, "error landmarks %s failed\n", action.c_str());
+	}
+	else if (word == "path")
+	{
+		inside = in >> x >> y >> gx >> gy && x >= 0 && x < map->width() && y >= 0 && y < map->height()
+			&& gx >= 0 && gx < map->width() && gy >= 0 && gy < map->height();
+
+		if (!inside)
+			appendReply(out, "error unit outside the map\n");
+		else if (!map->findPath(state.context, { x, y }, { gx, gy }))
+			appendReply(out, "none\n");
+		else
+		{
+			appendReply(out, "path %g %d", state.context.stats.pathCost, (int)state.context.path.size());
+			for (int id : state.context.path)
+			{
+				Position p = map->position(id);
+				appendReply(out, " %d %d", p.x, p.y);
+			}
+			appendReply(out, "\n");
+		}
+	}
+	else if (word == "stats")
+	{
+		const SearchStats &s = state.context.stats;
+		appendReply(out, "stats popped %d pushed %d decreased %d peak %d length %d cost %g ms %g\n", s.popped, s.pushed,
+			s.decreased, s.peakOpen, s.pathLength, s.pathCost, s.milliseconds);
+	}
+	else
+		appendReply(out, "error unknown command %s\n", word.c_str());
+
+	return true;
+}
+
+//Serves one client until it sends quit or closes. Returns false on quit.
+static bool serve(ServerState &state, FILE *in, FILE *out)
+{
+	std::string line, reply;
+	while (readLine(in, line))
+	{
+		reply.clear();
+		bool more = command(state, line, reply);
+
+		//Flush per reply so a client can wait for each answer
+		fputs(reply.c_str(), out);
+		fflush(out);
+		if (!more)
+			return false;
+	}
+	return true;
+}
+
+#ifndef _WIN32
+//Longest line a socket client may send. A client whose unfinished line grows past it is dropped.
+static const size_t maxLine = 4096;
+//Replies a socket client may have waiting before the server stops reading its commands until it reads them
+static const size_t maxQueued = 1 << 20;
+//Commands run for one client before the others get a turn
+static const int linesPerTurn = 16;
+
+//A socket client, with the part of its input that doesn't make a whole line yet and the replies it hasn't read
+struct Client {
+	int socket;
+	std::string pending;
+	std::string replies;
+	size_t sent = 0; //Bytes of replies already written
+	bool ended = false; //It sent everything it is going to
+	bool dropped = false;
+};
+
+//Whether the client has a whole line it can run now
+static bool runnable(const Client &c)
+{
+	return !c.dropped && c.replies.size() - c.sent < maxQueued && c.pending.find('\n') != std::string::npos;
+}
+
+//Runs up to linesPerTurn whole lines a client has sent, while its replies fit in the queue. Returns false on quit.
+static bool runLines(ServerState &state, Client &c)
+{
+	size_t start = 0, end;
+	bool running = true;
+	for (int lines = 0; lines < linesPerTurn && running && c.replies.size() - c.sent < maxQueued
+		&& (end = c.pending.find('\n', start)) != std::string::npos; lines++)
+	{
+		std::string line = c.pending.substr(start, end - start);
+		start = end + 1;
+		if (!line.empty() && line.back() == '\r')
+			line.pop_back();
+
+		running = command(state, line, c.replies);
+	}
+	c.pending.erase(0, start);
+
+	if (c.pending.size() > maxLine && c.pending.find('\n') == std::string::npos)
+	{
+		fprintf(stderr, "dropped a client that sent a line over %d bytes\n", (int)maxLine);
+		c.dropped = true;
+	}
+	return running;
+}
+
+//Writes as much of a client's queued replies as the socket takes without blocking
+static void sendReplies(Client &c)
+{
+	while (c.sent < c.replies.size())
+	{
+		ssize_t n = write(c.socket, c.replies.data() + c.sent, c.replies.size() - c.sent);
+		if (n > 0)
+			c.sent += n;
+		else if (n == -1 && errno == EINTR)
+			continue;
+		else
+		{
+			if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK))
+				c.dropped = true;
+			break;
+		}
+	}
+
+	if (c.sent == c.replies.size())
+	{
+		c.replies.clear();
+		c.sent = 0;
+	}
+}
+
+//Serves every connected client from one thread, waiting on all of them at once, so a client that stays
+//connected doesn't keep the others out. Commands never run at the same time, the state needs no lock.
+//Sockets are non-blocking and replies wait in each client's queue until poll says the client can take them,
+//so a client that stops reading only holds up itself. A client's quit stops the server.
+static int serveSocket(ServerState &state, const char *path)
+{
+	sockaddr_un address;
+	if (strlen(path) >= sizeof(address.sun_path))
+	{
+		fprintf(stderr, "socket path too long\n");
+		return 1;
+	}
+
+	int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	strcpy(address.sun_path, path);
+	unlink(path);
+
+	if (listener == -1 || bind(listener, (sockaddr *)&address, sizeof(address)) == -1 || listen(listener, 8) == -1)
+	{
+		perror("socket");
+		return 1;
+	}
+
+	//A client that hangs up mid-reply must not take the server down
+	signal(SIGPIPE, SIG_IGN);
+
+	std::vector<Client> clients;
+	std::vector<pollfd> waiting;
+	bool running = true;
+
+	while (running)
+	{
+		//Lines left over from a turn run without waiting for more input
+		int timeout = -1;
+		waiting.assign(1, { listener, POLLIN, 0 });
+		for (const Client &c : clients)
+		{
+			if (runnable(c))
+				timeout = 0;
+
+			short events = 0;
+			if (!c.ended && c.replies.size() - c.sent < maxQueued)
+				events |= POLLIN;
+			if (c.sent < c.replies.size())
+				events |= POLLOUT;
+			waiting.push_back({ c.socket, events, 0 });
+		}
+
+		if (poll(waiting.data(), waiting.size(), timeout) == -1)
+		{
+			if (errno == EINTR)
+				continue;
+			perror("poll");
+			break;
+		}
+
+		for (size_t i = 1; i < waiting.size() && running; i++)
+		{
+			Client &c = clients[i - 1];
+			short revents = waiting[i].revents;
+			if (revents & POLLOUT)
+				sendReplies(c);
+
+			if ((waiting[i].events & POLLIN) && (revents & (POLLIN | POLLHUP | POLLERR)))
+			{
+				char buffer[4096];
+				ssize_t n = read(c.socket, buffer, sizeof(buffer));
+				if (n > 0)
+					c.pending.append(buffer, n);
+				else if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+				{
+					//A last line without an end of line still counts, as it does on stdin
+					if (!c.pending.empty())
+						c.pending += '\n';
+					c.ended = true;
+				}
+			}
+			else if (revents & (POLLERR | POLLNVAL))
+				c.dropped = true;
+
+			//Also runs lines left from the last turn or held back by a full queue
+			if (!c.dropped)
+				running = runLines(state, c);
+			if (!c.dropped && (revents & POLLOUT) == 0)
+				sendReplies(c);
+		}
+
+		//Clients that sent their last line leave once they have every reply
+		for (size_t i = 0; i < clients.size();)
+		{
+			Client &c = clients[i];
+			if (c.dropped || (c.ended && c.pending.empty() && c.sent == c.replies.size()))
+			{
+				close(c.socket);
+				clients.erase(clients.begin() + i);
+			}
+			else
+				i++;
+		}
+
+		if (running && (waiting[0].revents & POLLIN))
+		{
+			int client = accept(listener, nullptr, nullptr);
+			if (client == -1)
+				continue;
+
+			int flags = fcntl(client, F_GETFL);
+			if (flags == -1 || fcntl(client, F_SETFL, flags | O_NONBLOCK) == -1)
+			{
+				perror("fcntl");
+				close(client);
+				continue;
+			}
+
+			Client c;
+			c.socket = client;
+			clients.push_back(c);
+		}
+	}
+
+	//Whatever the sockets take now of the replies sent before the quit
+	for (Client &c : clients)
+	{
+		sendReplies(c);
+		close(c.socket);
+	}
+	close(listener);
+	unlink(path);
+	return 0;
+}
+#endif
+
+int main(int argc, char **argv)
+{
+	ServerState state;
+
+	if (argc == 3 && strcmp(argv[1], "--socket") == 0)
+	{
+#ifdef _WIN32
+		fprintf(stderr, "--socket is not supported on Windows, use stdin\n");
+		return 2;
+#else
+		return serveSocket(state, argv[2]);
+#endif
+	}
+	else if (argc != 1)
+	{
+		fprintf(stderr, "usage: server [--socket path]\n");
+		return 2;
+	}
+
+	serve(state, stdin, stdout);
+	return 0;
+}